@@ -3,8 +3,10 @@
 in vec2 v_texcoord;
 out vec4 frag_color;
 
-uniform sampler2D u_screen_texture;
+uniform sampler2D u_screen_texture;  // One 2-bit shade per texel (R8)
+uniform vec4 u_palette[4];           // Shade -> color
 
 void main() {
-    frag_color = texture(u_screen_texture, v_texcoord);
+    int shade = int(texture(u_screen_texture, v_texcoord).r * 255.0 + 0.5);
+    frag_color = u_palette[min(shade, 3)];
 }
@@ -0,0 +1,87 @@
+#pragma once
+#include "../core/types.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Minimal benchmark harness: every benchmark repeats its body until a minimum
+// wall time has passed and reports the cost per operation. Bodies return how
+// many operations (reads, emulated cycles, frames, ...) one call performed.
+
+struct BenchmarkOptions {
+    std::string filter;                 // Only run benchmarks whose name contains this
+    double min_time_ms = 200.0;         // Minimum measured time per benchmark
+    u32 frames = 600;                   // Frames per macro benchmark
+    std::vector<std::string> rom_paths; // Extra ROMs for the macro benchmarks
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::string unit;    // What one operation is
+    u64 operations = 0;
+    double seconds = 0.0;
+
+    double NanosecondsPerOp() const { return operations ? seconds * 1e9 / operations : 0.0; }
+    double OpsPerSecond() const { return seconds > 0.0 ? operations / seconds : 0.0; }
+};
+
+// Keep a value alive so the optimizer can't drop the work that produced it
+template <typename T>
+FORCE_INLINE void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(const BenchmarkOptions& options) : m_options(options) {}
+
+    const BenchmarkOptions& GetOptions() const { return m_options; }
+    const std::vector<BenchmarkResult>& GetResults() const { return m_results; }
+
+    bool IsEnabled(const std::string& name) const {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    // Repeat body() (returning operations performed) until min_time_ms has passed
+    template <typename Body>
+    void Run(const std::string& name, const std::string& unit, Body&& body) {
+        if (!IsEnabled(name)) return;
+
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up caches, branch predictors and the CPU block cache
+        DoNotOptimize(body());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.unit = unit;
+
+        const auto start = Clock::now();
+        const auto min_time = std::chrono::duration<double, std::milli>(m_options.min_time_ms);
+        while (Clock::now() - start < min_time) {
+            result.operations += body();
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        Report(result);
+    }
+
+    // Record a benchmark that did its own timing (macro benchmarks)
+    void Report(const BenchmarkResult& result);
+
+private:
+    BenchmarkOptions m_options;
+    std::vector<BenchmarkResult> m_results;
+};
+
+// Benchmark groups (one translation unit each)
+void RunMemoryBenchmarks(BenchmarkRunner& runner);
+void RunCPUBenchmarks(BenchmarkRunner& runner);
+void RunPPUBenchmarks(BenchmarkRunner& runner);
+void RunSchedulerBenchmarks(BenchmarkRunner& runner);
+void RunMachineBenchmarks(BenchmarkRunner& runner);
@@ -0,0 +1,126 @@
+#include "bench.hpp"
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+void BenchmarkRunner::Report(const BenchmarkResult& result) {
+    std::fprintf(stderr, "%-36s %12.2f ns/%-8s %14.0f %s/s\n",
+                 result.name.c_str(), result.NanosecondsPerOp(), result.unit.c_str(),
+                 result.OpsPerSecond(), result.unit.c_str());
+    m_results.push_back(result);
+}
+
+namespace {
+
+void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options] [rom...]\n"
+        "\n"
+        "Runs the micro benchmarks and the macro (frames/second) benchmarks on\n"
+        "the built-in synthetic ROMs plus any ROMs given, and prints JSON.\n"
+        "\n"
+        "Options:\n"
+        "  --filter TEXT    Only run benchmarks whose name contains TEXT\n"
+        "  --min-time MS    Minimum run time per micro benchmark (default 200)\n"
+        "  --frames N       Frames per macro benchmark (default 600)\n"
+        "  -o, --output F   Write the JSON report to F instead of stdout\n"
+        "  -h, --help       Show this help\n",
+        program);
+}
+
+// Decimal digits only; values that don't fit a u32 are rejected
+bool ParseCount(const std::string& text, u32& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+// A finite, non-negative duration such as "200" or "0.5"
+bool ParseMilliseconds(const std::string& text, double& value) {
+    double parsed = 0.0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (error != std::errc() || end != text.data() + text.size() || !std::isfinite(parsed) || parsed < 0.0) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    BenchmarkOptions options;
+    std::string output_path;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && has_value) {
+            if (!ParseMilliseconds(argv[++i], options.min_time_ms)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--frames" && has_value) {
+            if (!ParseCount(argv[++i], options.frames) || options.frames == 0) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if ((arg == "-o" || arg == "--output") && has_value) {
+            output_path = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            PrintUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        } else {
+            options.rom_paths.push_back(arg);
+        }
+    }
+
+    BenchmarkRunner runner(options);
+    RunMemoryBenchmarks(runner);
+    RunCPUBenchmarks(runner);
+    RunPPUBenchmarks(runner);
+    RunSchedulerBenchmarks(runner);
+    RunMachineBenchmarks(runner);
+
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const BenchmarkResult& result : runner.GetResults()) {
+        benchmarks.push_back({
+            {"name", result.name},
+            {"unit", result.unit},
+            {"operations", result.operations},
+            {"seconds", result.seconds},
+            {"ns_per_op", result.NanosecondsPerOp()},
+            {"ops_per_second", result.OpsPerSecond()},
+        });
+    }
+
+    const nlohmann::json report = {
+        {"min_time_ms", options.min_time_ms},
+        {"frames", options.frames},
+        {"benchmarks", benchmarks},
+    };
+
+    if (output_path.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream file(output_path);
+        if (!file.is_open()) {
+            spdlog::error("Failed to write report: {}", output_path);
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "bench.hpp"
+#include "synthetic_rom.hpp"
+#include "../core/cpu/cpu.hpp"
+
+namespace {
+
+constexpr u64 CYCLES_PER_CALL = 1 << 16;
+
+constexpr OpcodeMix s_mixes[] = {
+    OpcodeMix::ALU,
+    OpcodeMix::Load,
+    OpcodeMix::Branch,
+    OpcodeMix::Bitwise,
+    OpcodeMix::Mixed,
+};
+
+}  // namespace
+
+void RunCPUBenchmarks(BenchmarkRunner& runner) {
+    for (OpcodeMix mix : s_mixes) {
+        const std::string name = std::string("cpu/") + GetOpcodeMixName(mix);
+        if (!runner.IsEnabled(name)) continue;
+
+        // CPU and memory only: nothing is scheduled, so RunUntil never stops early
+        const std::vector<u8> rom = BuildOpcodeMixROM(mix);
+        Scheduler scheduler;
+        Memory memory;
+        memory.LoadROM(rom.data(), rom.size());
+        CPU cpu(memory, scheduler);
+
+        runner.Run(name, "cycle", [&] {
+            const u64 start = scheduler.GetCurrentCycle();
+            cpu.RunUntil(start + CYCLES_PER_CALL);
+            return scheduler.GetCurrentCycle() - start;
+        });
+    }
+}
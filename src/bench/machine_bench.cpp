@@ -0,0 +1,188 @@
+#include "bench.hpp"
+#include "synthetic_rom.hpp"
+#include "../machine/gameboy.hpp"
+#include "../machine/gameboy_batch.hpp"
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// Displayed frames per second; with run_ahead each one emulates 1 + run_ahead frames
+void RunFrames(BenchmarkRunner& runner, const std::string& name, GameBoy& gameboy, u32 run_ahead = 0) {
+    const u32 frames = runner.GetOptions().frames;
+
+    // One warm-up frame fills the block cache
+    gameboy.RunFrameAhead(run_ahead);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.unit = "frame";
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 frame = 0; frame < frames; frame++) {
+        DoNotOptimize(gameboy.RunFrameAhead(run_ahead));
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.operations = frames;
+
+    runner.Report(result);
+}
+
+}  // namespace
+
+void RunMachineBenchmarks(BenchmarkRunner& runner) {
+    // Built-in ROMs, so the suite runs without any game images
+    for (bool busy : {false, true}) {
+        const std::string name = busy ? "machine/synthetic_busy" : "machine/synthetic_halt";
+        if (!runner.IsEnabled(name)) continue;
+
+        GameBoy gameboy;
+        if (!gameboy.LoadROM(BuildDemoROM(busy))) continue;
+        RunFrames(runner, name, gameboy);
+    }
+
+    // Same game-like workload without pixel work
+    if (runner.IsEnabled("machine/synthetic_halt_timing_only")) {
+        GameBoy gameboy;
+        if (gameboy.LoadROM(BuildDemoROM(false))) {
+            gameboy.SetRenderPolicy(PPU::RenderPolicy::TIMING_ONLY);
+            RunFrames(runner, "machine/synthetic_halt_timing_only", gameboy);
+        }
+    }
+
+    // Same workload recording a rewind point every frame
+    if (runner.IsEnabled("machine/synthetic_halt_rewind")) {
+        GameBoy gameboy;
+        if (gameboy.LoadROM(BuildDemoROM(false))) {
+            gameboy.EnableRewind(4 * 1024 * 1024);
+            RunFrames(runner, "machine/synthetic_halt_rewind", gameboy);
+        }
+    }
+
+    // Same workload synthesizing 48 kHz audio with all four channels playing.
+    // Nothing drains the ring; once it is full the blocks are dropped, which
+    // leaves the synthesis cost intact
+    if (runner.IsEnabled("machine/synthetic_halt_audio")) {
+        GameBoy gameboy;
+        SampleRing ring(1 << 16);
+        if (gameboy.LoadROM(BuildDemoROM(false))) {
+            gameboy.SetAudioOutput(&ring, 48000);
+
+            Memory& memory = gameboy.GetMemory();
+            memory.Write(0xFF24, 0x77);  // NR50: full volume
+            memory.Write(0xFF25, 0xFF);  // NR51: every channel on both sides
+            memory.Write(0xFF11, 0x80);  // Square 1 at ~440 Hz, 50% duty
+            memory.Write(0xFF12, 0xF0);
+            memory.Write(0xFF13, 0xD6);
+            memory.Write(0xFF14, 0x86);
+            memory.Write(0xFF16, 0x40);  // Square 2 at ~1.3 kHz, 25% duty
+            memory.Write(0xFF17, 0xF0);
+            memory.Write(0xFF18, 0x9D);
+            memory.Write(0xFF19, 0x87);
+            for (u16 address = 0xFF30; address < 0xFF40; address++) {
+                memory.Write(address, static_cast<u8>((address & 0x0F) * 0x11));
+            }
+            memory.Write(0xFF1A, 0x80);  // Wave: ramp at ~220 Hz
+            memory.Write(0xFF1C, 0x20);
+            memory.Write(0xFF1D, 0xD6);
+            memory.Write(0xFF1E, 0x86);
+            memory.Write(0xFF21, 0xF0);  // Noise, fast clock
+            memory.Write(0xFF22, 0x21);
+            memory.Write(0xFF23, 0x80);
+
+            RunFrames(runner, "machine/synthetic_halt_audio", gameboy);
+        }
+    }
+
+    // Frontend run-ahead: a snapshot, two speculative frames and a restore per frame
+    if (runner.IsEnabled("machine/synthetic_halt_run_ahead_2")) {
+        GameBoy gameboy;
+        if (gameboy.LoadROM(BuildDemoROM(false))) {
+            RunFrames(runner, "machine/synthetic_halt_run_ahead_2", gameboy, 2);
+        }
+    }
+
+    // RL-style lockstep stepping: 16 instances, 4 frames per step (only the
+    // last drawn), 80x72 grayscale observations and a few RAM bytes each
+    if (runner.IsEnabled("machine/batch_16x4")) {
+        constexpr size_t INSTANCES = 16;
+        constexpr u32 FRAMES_PER_STEP = 4;
+
+        GameBoyBatch::Config config;
+        config.observation = GameBoyBatch::Observation::GRAYSCALE;
+        config.downsample = 2;
+        config.memory_addresses = {0xC000, 0xC001, 0xC002};
+
+        GameBoyBatch batch(INSTANCES, config);
+        if (batch.LoadROM(ROMImage::FromData(BuildDemoROM(false)))) {
+            std::vector<u8> joypad(INSTANCES, 0xFF);
+            std::vector<u8> observations(INSTANCES * batch.GetObservationSize());
+            std::vector<u8> memory(INSTANCES * batch.GetMemorySize());
+
+            batch.Step(joypad.data(), 1, observations.data(), memory.data());
+            runner.Run("machine/batch_16x4", "frame", [&] {
+                batch.Step(joypad.data(), FRAMES_PER_STEP, observations.data(), memory.data());
+                DoNotOptimize(observations.data());
+                return u64{INSTANCES * FRAMES_PER_STEP};
+            });
+        }
+    }
+
+    // Save state round trip on a cartridge with banked RAM
+    if (runner.IsEnabled("machine/snapshot")) {
+        std::vector<u8> rom = BuildDemoROM(false);
+        rom[0x147] = 0x1B;  // MBC5+RAM+BATTERY
+        rom[0x149] = 0x03;  // 32KB
+
+        GameBoy gameboy;
+        if (gameboy.LoadROM(rom)) {
+            gameboy.RunFrame();
+
+            std::vector<u8> snapshot;
+            runner.Run("machine/snapshot/save", "save", [&] {
+                gameboy.SaveState(snapshot);
+                DoNotOptimize(snapshot.data());
+                return u64{1};
+            });
+            runner.Run("machine/snapshot/load", "load", [&] {
+                gameboy.LoadState(snapshot);
+                return u64{1};
+            });
+        }
+    }
+
+    // Instance startup from an 8MB MBC5 ROM file (mapped, not read)
+    if (runner.IsEnabled("machine/load_rom_8mb")) {
+        std::vector<u8> rom = BuildDemoROM(false);
+        rom.resize(8 * 1024 * 1024, 0xFF);
+        rom[0x147] = 0x19;  // MBC5
+        rom[0x148] = 0x08;  // 8MB
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "dmwss_bench_8mb.gb";
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(rom.data()), static_cast<std::streamsize>(rom.size()));
+        }
+
+        runner.Run("machine/load_rom_8mb", "load", [&] {
+            GameBoy gameboy;
+            DoNotOptimize(gameboy.LoadROM(path.string()));
+            return u64{1};
+        });
+
+        std::filesystem::remove(path);
+    }
+
+    for (const std::string& path : runner.GetOptions().rom_paths) {
+        const std::string name = "machine/" + std::filesystem::path(path).stem().string();
+        if (!runner.IsEnabled(name)) continue;
+
+        GameBoy gameboy;
+        if (!gameboy.LoadROM(path)) {
+            spdlog::error("Skipping benchmark ROM: {}", path);
+            continue;
+        }
+        RunFrames(runner, name, gameboy);
+    }
+}
@@ -0,0 +1,137 @@
+#include "bench.hpp"
+#include "synthetic_rom.hpp"
+#include "../core/memory/memory.hpp"
+
+namespace {
+
+struct Region {
+    const char* name;
+    u16 start;
+    u16 size;
+};
+
+constexpr Region s_read_regions[] = {
+    {"rom0", 0x0000, 0x4000},
+    {"romx", 0x4000, 0x4000},
+    {"vram", 0x8000, 0x2000},
+    {"sram", 0xA000, 0x2000},
+    {"wram", 0xC000, 0x2000},
+    {"echo", 0xE000, 0x1E00},
+    {"oam",  0xFE00, 0x00A0},
+    {"io",   0xFF00, 0x0080},
+    {"hram", 0xFF80, 0x007F},
+};
+
+constexpr Region s_write_regions[] = {
+    {"vram", 0x8000, 0x2000},
+    {"sram", 0xA000, 0x2000},
+    {"wram", 0xC000, 0x2000},
+    {"echo", 0xE000, 0x1E00},
+    {"oam",  0xFE00, 0x00A0},
+    {"io",   0xFF30, 0x0010},  // Wave RAM: plain storage, no side effects
+    {"hram", 0xFF80, 0x007F},
+};
+
+constexpr u64 ACCESSES_PER_CALL = 4096;
+
+}  // namespace
+
+void RunMemoryBenchmarks(BenchmarkRunner& runner) {
+    // MBC1 + 8KB RAM, 4 ROM banks so bank switches have somewhere to go
+    std::vector<u8> rom = BuildBlankROM(0x03, 0x02);
+    rom.resize(0x10000, 0x00);
+    rom[0x148] = 0x01;
+
+    Memory memory;
+    memory.LoadROM(rom.data(), rom.size());
+    memory.Write(0x0000, 0x0A);  // Enable cartridge RAM
+
+    for (const Region& region : s_read_regions) {
+        runner.Run(std::string("memory/read/") + region.name, "read", [&] {
+            u32 sum = 0;
+            u16 offset = 0;
+            for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+                sum += memory.Read(region.start + offset);
+                if (++offset == region.size) offset = 0;
+            }
+            DoNotOptimize(sum);
+            return ACCESSES_PER_CALL;
+        });
+    }
+
+    for (const Region& region : s_write_regions) {
+        runner.Run(std::string("memory/write/") + region.name, "write", [&] {
+            u16 offset = 0;
+            for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+                memory.Write(region.start + offset, static_cast<u8>(i));
+                if (++offset == region.size) offset = 0;
+            }
+            return ACCESSES_PER_CALL;
+        });
+    }
+
+    runner.Run("memory/read16/wram", "read", [&] {
+        u32 sum = 0;
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            sum += memory.Read16(0xC000 + static_cast<u16>((i * 2) & 0x1FFE));
+        }
+        DoNotOptimize(sum);
+        return ACCESSES_PER_CALL;
+    });
+
+    runner.Run("memory/write16/wram", "write", [&] {
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            memory.Write16(0xC000 + static_cast<u16>((i * 2) & 0x1FFE), static_cast<u16>(i));
+        }
+        return ACCESSES_PER_CALL;
+    });
+
+    // HRAM stack traffic (FF80-FFFD), as during init or in DMA routines
+    runner.Run("memory/read16/hram", "read", [&] {
+        u32 sum = 0;
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            sum += memory.Read16(0xFF80 + static_cast<u16>((i * 2) & 0x7C));
+        }
+        DoNotOptimize(sum);
+        return ACCESSES_PER_CALL;
+    });
+
+    runner.Run("memory/write16/hram", "write", [&] {
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            memory.Write16(0xFF80 + static_cast<u16>((i * 2) & 0x7C), static_cast<u16>(i));
+        }
+        return ACCESSES_PER_CALL;
+    });
+
+    // ROM bank register writes remap the fastmem pages of 0x4000-0x7FFF
+    runner.Run("memory/write/mbc_bank_switch", "write", [&] {
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            memory.Write(0x2000, static_cast<u8>(1 + (i & 1)));
+        }
+        return ACCESSES_PER_CALL;
+    });
+
+    // MBC3 RTC registers never reach the page tables: every access goes
+    // through the mapper
+    std::vector<u8> rtc_rom = BuildBlankROM(0x10, 0x02);
+    Memory rtc_memory;
+    rtc_memory.LoadROM(rtc_rom.data(), rtc_rom.size());
+    rtc_memory.Write(0x0000, 0x0A);  // Enable RAM and RTC
+    rtc_memory.Write(0x4000, 0x08);  // Select the seconds register
+
+    runner.Run("memory/read/mbc3_rtc", "read", [&] {
+        u32 sum = 0;
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            sum += rtc_memory.Read(0xA000 + static_cast<u16>(i & 0x1FFF));
+        }
+        DoNotOptimize(sum);
+        return ACCESSES_PER_CALL;
+    });
+
+    runner.Run("memory/write/mbc3_rtc", "write", [&] {
+        for (u64 i = 0; i < ACCESSES_PER_CALL; i++) {
+            rtc_memory.Write(0xA000 + static_cast<u16>(i & 0x1FFF), static_cast<u8>(i % 60));
+        }
+        return ACCESSES_PER_CALL;
+    });
+}
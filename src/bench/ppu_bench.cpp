@@ -0,0 +1,148 @@
+#include "bench.hpp"
+#include "../core/dma/dma.hpp"
+#include "../core/ppu/ppu.hpp"
+#include <spdlog/spdlog.h>
+
+namespace {
+
+constexpr u32 CYCLES_PER_FRAME = 70224;
+constexpr u64 VISIBLE_LINES = 144;
+constexpr u64 POLLS_PER_CALL = 4096;
+
+struct Scene {
+    const char* name;
+    u8 lcdc;
+};
+
+constexpr Scene s_scenes[] = {
+    {"bg", 0x91},                 // LCD, BG, tile data 8000
+    {"bg_window_sprites", 0xF3},  // + window, 8x16 sprites
+};
+
+// Same picture as the demo ROM, written straight into VRAM/OAM
+void FillVideoMemory(Memory& memory) {
+    u8* vram = memory.GetVRAM();
+    for (u32 address = 0x8000; address < 0x9000; address++) {
+        vram[address - 0x8000] = static_cast<u8>((address & 0xFF) ^ (address >> 8));
+    }
+    for (u32 address = 0x9800; address < 0xA000; address++) {
+        vram[address - 0x8000] = static_cast<u8>(address & 0xFF);
+    }
+
+    u8* oam = memory.GetOAM();
+    for (u32 i = 0; i < 40; i++) {
+        oam[i * 4 + 0] = static_cast<u8>(16 + i * 3);
+        oam[i * 4 + 1] = static_cast<u8>(8 + i * 4);
+        oam[i * 4 + 2] = static_cast<u8>(i);
+        oam[i * 4 + 3] = static_cast<u8>((i << 4) & 0xF0);
+    }
+
+    memory.Write(0xFF47, 0xE4);  // BGP
+    memory.Write(0xFF48, 0xD2);  // OBP0
+    memory.Write(0xFF49, 0x1B);  // OBP1
+    memory.Write(0xFF4A, 0x50);  // WY
+    memory.Write(0xFF4B, 0x57);  // WX
+}
+
+}  // namespace
+
+void RunPPUBenchmarks(BenchmarkRunner& runner) {
+    for (const Scene& scene : s_scenes) {
+        const std::string name = std::string("ppu/scanline/") + scene.name;
+        if (!runner.IsEnabled(name)) continue;
+
+        // PPU driven by its scheduler events alone, one frame per call
+        Scheduler scheduler;
+        Memory memory;
+        PPU ppu(memory, scheduler);
+        FillVideoMemory(memory);
+        memory.Write(0xFF40, scene.lcdc);
+
+        runner.Run(name, "scanline", [&] {
+            scheduler.Advance(CYCLES_PER_FRAME);
+            scheduler.ProcessEvents();
+            DoNotOptimize(ppu.GetShadeFramebuffer()[0]);
+            return VISIBLE_LINES;
+        });
+    }
+
+    // ARGB expansion for consumers that want 32-bit pixels (screenshots)
+    if (runner.IsEnabled("ppu/expand_argb")) {
+        Scheduler scheduler;
+        Memory memory;
+        PPU ppu(memory, scheduler);
+        FillVideoMemory(memory);
+        memory.Write(0xFF40, 0x91);
+        scheduler.Advance(CYCLES_PER_FRAME);
+        scheduler.ProcessEvents();
+
+        std::array<u32, PPU::SCREEN_WIDTH * PPU::SCREEN_HEIGHT> argb;
+        runner.Run("ppu/expand_argb", "pixel", [&] {
+            ExpandShades(argb.data(), ppu.GetShadeFramebuffer(), argb.size());
+            DoNotOptimize(argb[0]);
+            return static_cast<u64>(argb.size());
+        });
+    }
+
+    // Sprites moved through OAM DMA every frame, as games do: each frame
+    // rebuilds the PPU's per-line sprite index once
+    if (runner.IsEnabled("ppu/scanline/dma_sprites")) {
+        Scheduler scheduler;
+        Memory memory;
+        PPU ppu(memory, scheduler);
+        DMA dma(memory, scheduler);
+
+        // Tile 1 solid color 3, BG off, OBP0 identity: sprites draw shade 3 on white
+        for (u16 address = 0x8010; address < 0x8020; address++) {
+            memory.Write(address, 0xFF);
+        }
+        memory.Write(0xFF48, 0xE4);
+        memory.Write(0xFF40, 0x82);  // LCD, 8x8 sprites
+
+        // 40 sprites in a diagonal, shifted right by one pixel per frame
+        u8 frame = 0;
+        auto run_frame = [&] {
+            for (u16 i = 0; i < 40; i++) {
+                memory.Write(0xC000 + i * 4 + 0, static_cast<u8>(16 + 10 + i * 3));
+                memory.Write(0xC000 + i * 4 + 1, static_cast<u8>(8 + 10 + frame + i * 2));
+                memory.Write(0xC000 + i * 4 + 2, 1);
+                memory.Write(0xC000 + i * 4 + 3, 0);
+            }
+            memory.Write(0xFF46, 0xC0);
+            scheduler.Advance(CYCLES_PER_FRAME);
+            scheduler.ProcessEvents();
+            frame = (frame + 1) % 64;
+        };
+
+        // The first sprite must show up at (10, 10) once its DMA has landed
+        run_frame();
+        const u8* shades = ppu.GetShadeFramebuffer();
+        if (shades[10 * PPU::SCREEN_WIDTH + 10] != 3 || shades[10 * PPU::SCREEN_WIDTH + 9] != 0) {
+            spdlog::error("ppu/scanline/dma_sprites: DMA-loaded sprite not drawn");
+        } else {
+            runner.Run("ppu/scanline/dma_sprites", "scanline", [&] {
+                run_frame();
+                DoNotOptimize(ppu.GetShadeFramebuffer()[0]);
+                return VISIBLE_LINES;
+            });
+        }
+    }
+
+    // LY/STAT busy-wait polling, the hottest I/O pattern in most games
+    if (runner.IsEnabled("ppu/io/poll_ly_stat")) {
+        Scheduler scheduler;
+        Memory memory;
+        PPU ppu(memory, scheduler);
+        memory.Write(0xFF40, 0x91);
+
+        runner.Run("ppu/io/poll_ly_stat", "read", [&] {
+            u32 sum = 0;
+            for (u64 i = 0; i < POLLS_PER_CALL; i += 2) {
+                sum += memory.Read(0xFF44);
+                sum += memory.Read(0xFF41);
+            }
+            DoNotOptimize(sum);
+            return POLLS_PER_CALL;
+        });
+    }
+}
@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "../core/scheduler/scheduler.hpp"
+
+namespace {
+
+constexpr u64 CALLS_PER_RUN = 4096;
+
+// Self-rescheduling event, like the PPU mode and timer events
+struct PeriodicEvent {
+    Scheduler* scheduler;
+    Scheduler::EventType type;
+    u64 period;
+    u64 fired;
+};
+
+void OnPeriodicEvent(void* context) {
+    PeriodicEvent* event = static_cast<PeriodicEvent*>(context);
+    event->fired++;
+    event->scheduler->Schedule(event->type, event->period);
+}
+
+}  // namespace
+
+void RunSchedulerBenchmarks(BenchmarkRunner& runner) {
+    using EventType = Scheduler::EventType;
+
+    constexpr EventType types[] = {
+        EventType::HBLANK, EventType::LCD_TRANSFER, EventType::VBLANK, EventType::TIMER_OVERFLOW
+    };
+
+    runner.Run("scheduler/schedule", "call", [&] {
+        Scheduler scheduler;
+        for (u64 i = 0; i < CALLS_PER_RUN; i++) {
+            scheduler.Schedule(types[i & 3], 64 + (i & 0xFF));
+        }
+        DoNotOptimize(scheduler.GetCyclesUntilNextEvent());
+        return CALLS_PER_RUN;
+    });
+
+    // The pattern the CPU loop produces: advance a few cycles, poll, sometimes fire
+    Scheduler scheduler;
+    PeriodicEvent events[] = {
+        {&scheduler, EventType::HBLANK, 456, 0},
+        {&scheduler, EventType::LCD_TRANSFER, 80, 0},
+        {&scheduler, EventType::VBLANK, 4560, 0},
+        {&scheduler, EventType::TIMER_OVERFLOW, 1024, 0},
+    };
+
+    for (PeriodicEvent& event : events) {
+        scheduler.RegisterEvent(event.type, OnPeriodicEvent, &event);
+        scheduler.Schedule(event.type, event.period);
+    }
+
+    runner.Run("scheduler/process_events", "call", [&] {
+        for (u64 i = 0; i < CALLS_PER_RUN; i++) {
+            scheduler.Advance(4);
+            scheduler.ProcessEvents();
+        }
+        return CALLS_PER_RUN;
+    });
+
+    DoNotOptimize(events[0].fired);
+}
@@ -0,0 +1,199 @@
+#include "synthetic_rom.hpp"
+
+namespace {
+
+constexpr size_t ROM_SIZE = 0x8000;
+constexpr u16 CODE_START = 0x0150;
+constexpr size_t BODY_REPEAT = 32;  // Loop bodies per pass, so blocks stay long
+
+class CodeWriter {
+public:
+    CodeWriter(std::vector<u8>& rom, u16 origin) : m_rom(rom), m_address(origin) {}
+
+    u16 GetAddress() const { return m_address; }
+
+    void Emit(std::initializer_list<u8> bytes) {
+        for (u8 byte : bytes) {
+            m_rom[m_address++] = byte;
+        }
+    }
+
+    void Jump(u16 target) {
+        Emit({0xC3, static_cast<u8>(target & 0xFF), static_cast<u8>(target >> 8)});
+    }
+
+    // JR/JR cc to an address within range
+    void RelativeJump(u8 opcode, u16 target) {
+        const s32 offset = static_cast<s32>(target) - static_cast<s32>(m_address + 2);
+        Emit({opcode, static_cast<u8>(static_cast<s8>(offset))});
+    }
+
+private:
+    std::vector<u8>& m_rom;
+    u16 m_address;
+};
+
+void EmitALU(CodeWriter& code) {
+    code.Emit({0x80, 0x91, 0xA2, 0xB3, 0xAC, 0xBD});  // ADD B, SUB C, AND D, OR E, XOR H, CP L
+    code.Emit({0x04, 0x0D, 0x09, 0x13, 0x27, 0x2F});  // INC B, DEC C, ADD HL,BC, INC DE, DAA, CPL
+    code.Emit({0x8F, 0xC6, 0x11, 0xD6, 0x07});        // ADC A,A, ADD A,n, SUB n
+}
+
+void EmitLoad(CodeWriter& code) {
+    code.Emit({0x78, 0x41, 0x22, 0x7E, 0x2A});        // LD A,B, LD B,C, LD (HL+),A, LD A,(HL), LD A,(HL+)
+    code.Emit({0x36, 0x5A, 0xEA, 0x00, 0xC1});        // LD (HL),n, LD (C100),A
+    code.Emit({0xFA, 0x00, 0xC1, 0xE0, 0x80});        // LD A,(C100), LDH (80),A
+    code.Emit({0xF0, 0x80, 0xC5, 0xD1});              // LDH A,(80), PUSH BC, POP DE
+}
+
+void EmitBranch(CodeWriter& code) {
+    code.Emit({0x06, 0x04});                          // LD B,4
+    const u16 loop = code.GetAddress();
+    code.Emit({0x05});                                // DEC B
+    code.RelativeJump(0x20, loop);                    // JR NZ,loop
+    code.Emit({0xCD, 0x30, 0x00});                    // CALL 0030 (RET)
+    code.Emit({0xFF});                                // RST 38 (RET)
+    code.Jump(code.GetAddress() + 3);                 // JP next
+}
+
+void EmitBitwise(CodeWriter& code) {
+    code.Emit({0xCB, 0x37, 0xCB, 0x00, 0xCB, 0x19});  // SWAP A, RLC B, RR C
+    code.Emit({0xCB, 0x22, 0xCB, 0x3B, 0xCB, 0x47});  // SLA D, SRL E, BIT 0,A
+    code.Emit({0xCB, 0xC8, 0xCB, 0x91});              // SET 1,B, RES 2,C
+    code.Emit({0xCB, 0x46, 0xCB, 0xC6});              // BIT 0,(HL), SET 0,(HL)
+}
+
+void EmitMix(CodeWriter& code, OpcodeMix mix) {
+    switch (mix) {
+        case OpcodeMix::ALU: EmitALU(code); break;
+        case OpcodeMix::Load: EmitLoad(code); break;
+        case OpcodeMix::Branch: EmitBranch(code); break;
+        case OpcodeMix::Bitwise: EmitBitwise(code); break;
+        case OpcodeMix::Mixed:
+            EmitALU(code);
+            EmitLoad(code);
+            EmitBranch(code);
+            EmitBitwise(code);
+            break;
+    }
+}
+
+// Endless workload loop; HL is reset every pass so (HL) accesses stay in WRAM
+void EmitWorkloadLoop(CodeWriter& code, OpcodeMix mix, size_t repeat) {
+    const u16 loop = code.GetAddress();
+    code.Emit({0x21, 0x00, 0xC0});                    // LD HL,C000
+
+    for (size_t i = 0; i < repeat; i++) {
+        EmitMix(code, mix);
+    }
+
+    code.Jump(loop);
+}
+
+}  // namespace
+
+const char* GetOpcodeMixName(OpcodeMix mix) {
+    switch (mix) {
+        case OpcodeMix::ALU: return "alu";
+        case OpcodeMix::Load: return "load";
+        case OpcodeMix::Branch: return "branch";
+        case OpcodeMix::Bitwise: return "bitwise";
+        case OpcodeMix::Mixed: return "mixed";
+    }
+    return "unknown";
+}
+
+std::vector<u8> BuildBlankROM(u8 cartridge_type, u8 ram_size) {
+    std::vector<u8> rom(ROM_SIZE, 0x00);
+
+    // Entry point: NOP; JP 0150
+    rom[0x100] = 0x00;
+    rom[0x101] = 0xC3;
+    rom[0x102] = CODE_START & 0xFF;
+    rom[0x103] = CODE_START >> 8;
+
+    const char title[] = "DMWSS BENCH";
+    for (size_t i = 0; i + 1 < sizeof(title); i++) {
+        rom[0x134 + i] = static_cast<u8>(title[i]);
+    }
+
+    rom[0x147] = cartridge_type;
+    rom[0x148] = 0x00;  // 32KB
+    rom[0x149] = ram_size;
+
+    // Targets of the CALL/RST in the branch mix
+    rom[0x30] = 0xC9;  // RET
+    rom[0x38] = 0xC9;  // RET
+
+    return rom;
+}
+
+std::vector<u8> BuildOpcodeMixROM(OpcodeMix mix) {
+    std::vector<u8> rom = BuildBlankROM(0x00, 0x00);
+
+    CodeWriter code(rom, CODE_START);
+    EmitWorkloadLoop(code, mix, BODY_REPEAT);
+
+    return rom;
+}
+
+std::vector<u8> BuildDemoROM(bool busy) {
+    std::vector<u8> rom = BuildBlankROM(0x00, 0x00);
+
+    // VBlank handler: scroll the background one pixel per frame
+    CodeWriter vblank(rom, 0x0040);
+    vblank.Emit({0xF5, 0xF0, 0x43, 0x3C, 0xE0, 0x43, 0xF1, 0xD9});  // PUSH AF; SCX++; POP AF; RETI
+
+    // Timer handler: count overflows in C001
+    CodeWriter timer(rom, 0x0050);
+    timer.Emit({0xF5, 0xFA, 0x01, 0xC0, 0x3C, 0xEA, 0x01, 0xC0, 0xF1, 0xD9});
+
+    CodeWriter code(rom, CODE_START);
+    code.Emit({0xF3, 0x31, 0xFE, 0xFF});              // DI; LD SP,FFFE
+
+    // Wait for VBlank, then turn the LCD off while filling VRAM
+    const u16 wait = code.GetAddress();
+    code.Emit({0xF0, 0x44, 0xFE, 0x90});              // LDH A,(LY); CP 144
+    code.RelativeJump(0x38, wait);                    // JR C,wait
+    code.Emit({0xAF, 0xE0, 0x40});                    // XOR A; LDH (LCDC),A
+
+    // Tile data 8000-8FFF: byte = L ^ H
+    code.Emit({0x21, 0x00, 0x80});
+    const u16 tiles = code.GetAddress();
+    code.Emit({0x7D, 0xAC, 0x22, 0x7C, 0xFE, 0x90});
+    code.RelativeJump(0x20, tiles);
+
+    // Tile maps 9800-9FFF: tile = L
+    code.Emit({0x21, 0x00, 0x98});
+    const u16 map = code.GetAddress();
+    code.Emit({0x7D, 0x22, 0x7C, 0xFE, 0xA0});
+    code.RelativeJump(0x20, map);
+
+    // 40 sprites spread over the screen: y = 16 + 3i, x = 8 + 4i, tile i, flags i << 4
+    code.Emit({0x21, 0x00, 0xFE, 0x06, 0x00});
+    const u16 sprites = code.GetAddress();
+    code.Emit({0x78, 0x87, 0x80, 0xC6, 0x10, 0x22});
+    code.Emit({0x78, 0x87, 0x87, 0xC6, 0x08, 0x22});
+    code.Emit({0x78, 0x22});
+    code.Emit({0x78, 0xCB, 0x37, 0xE6, 0xF0, 0x22});
+    code.Emit({0x04, 0x78, 0xFE, 40});
+    code.RelativeJump(0x20, sprites);
+
+    code.Emit({0x3E, 0xE4, 0xE0, 0x47, 0x3E, 0xD2, 0xE0, 0x48, 0x3E, 0x1B, 0xE0, 0x49});  // BGP, OBP0, OBP1
+    code.Emit({0x3E, 0x50, 0xE0, 0x4A, 0x3E, 0x57, 0xE0, 0x4B});  // WY, WX
+    code.Emit({0x3E, 0x05, 0xE0, 0x07});              // TAC: enabled, 262144 Hz
+    code.Emit({0x3E, 0x05, 0xEA, 0xFF, 0xFF});        // IE: VBlank | Timer
+    code.Emit({0xAF, 0xE0, 0x0F});                    // IF = 0
+    code.Emit({0x3E, 0xF3, 0xE0, 0x40});              // LCDC: LCD, window, 8x16 sprites, BG
+    code.Emit({0xFB});                                // EI
+
+    if (busy) {
+        EmitWorkloadLoop(code, OpcodeMix::Mixed, 8);
+    } else {
+        const u16 main = code.GetAddress();
+        code.Emit({0x76});                            // HALT
+        code.RelativeJump(0x18, main);                // JR main
+    }
+
+    return rom;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "../core/types.hpp"
+
+// Small generated ROMs so the benchmarks need no bundled game images
+
+enum class OpcodeMix {
+    ALU,      // 8/16-bit arithmetic and logic on registers
+    Load,     // Register, immediate, WRAM/HRAM and stack transfers
+    Branch,   // Loops, CALL/RET, RST and absolute jumps
+    Bitwise,  // CB-prefixed rotates, shifts and bit operations
+    Mixed     // All of the above interleaved
+};
+
+const char* GetOpcodeMixName(OpcodeMix mix);
+
+// 32KB ROM-only cartridge that runs the given instruction mix in an endless loop
+std::vector<u8> BuildOpcodeMixROM(OpcodeMix mix);
+
+// Blank cartridge image with a valid header (code at 0x150 is all NOPs)
+std::vector<u8> BuildBlankROM(u8 cartridge_type, u8 ram_size);
+
+// Game-like ROM: LCD on with background, window and 40 sprites, a VBlank
+// handler scrolling the background and a timer interrupt. With busy = false
+// the main loop HALTs between interrupts like most games do; with busy = true
+// it keeps running the mixed instruction workload.
+std::vector<u8> BuildDemoROM(bool busy);
@@ -0,0 +1,561 @@
+#include "apu.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace {
+
+// Register addresses
+constexpr u16 NR10 = 0xFF10, NR11 = 0xFF11, NR12 = 0xFF12, NR13 = 0xFF13, NR14 = 0xFF14;
+constexpr u16 NR21 = 0xFF16, NR22 = 0xFF17, NR23 = 0xFF18, NR24 = 0xFF19;
+constexpr u16 NR30 = 0xFF1A, NR31 = 0xFF1B, NR32 = 0xFF1C, NR33 = 0xFF1D, NR34 = 0xFF1E;
+constexpr u16 NR41 = 0xFF20, NR42 = 0xFF21, NR43 = 0xFF22, NR44 = 0xFF23;
+constexpr u16 NR50 = 0xFF24, NR51 = 0xFF25, NR52 = 0xFF26;
+constexpr u16 WAVE_RAM = 0xFF30;
+
+constexpr u8 NRX4_TRIGGER = 0x80;
+constexpr u8 NRX4_LENGTH_ENABLE = 0x40;
+
+// Bits that read back as 1, for 0xFF10-0xFF3F (NR52 has its own handler)
+constexpr std::array<u8, 0x30> READ_MASKS = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF,                          // NR10-NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,                          // unused, NR21-NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,                          // NR30-NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,                          // unused, NR41-NR44
+    0x00, 0x00, 0x70,                                      // NR50-NR52
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,  // unused
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,        // Wave RAM
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// Register values left by the boot ROM (its chime has finished by 0x0100)
+constexpr std::array<u8, 0x17> POST_BOOT_REGISTERS = {
+    0x80, 0xBF, 0xF3, 0xFF, 0xBF,
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,
+    0x77, 0xF3, 0x80,
+};
+
+// Duty cycle waveforms, one bit per step
+constexpr u8 DUTY_PATTERNS[4] = {0b00000001, 0b10000001, 0b10000111, 0b01111110};
+
+constexpr u8 NOISE_DIVISORS[8] = {8, 16, 32, 48, 64, 80, 96, 112};
+
+constexpr u16 SquareRegister(u32 index, u16 nr1x) { return static_cast<u16>(nr1x + index * 5); }
+
+}  // namespace
+
+APU::APU(Memory& memory, Scheduler& scheduler)
+    : m_memory(memory)
+    , m_scheduler(scheduler)
+    , m_registers{}
+    , m_square{}
+    , m_wave{}
+    , m_noise{}
+    , m_sequencer_step(0)
+    , m_output(nullptr)
+    , m_muted(false)
+    , m_muted_at(0)
+    , m_block_start(0)
+    , m_synced_cycle(0)
+    , m_contribution{} {
+
+    m_scheduler.RegisterEvent(Scheduler::EventType::APU_FRAME_SEQUENCER,
+        [](void* apu) { static_cast<APU*>(apu)->OnFrameSequencer(); }, this);
+
+    RegisterIOHandlers(std::make_index_sequence<REGISTER_COUNT>{});
+    Reset();
+}
+
+template <size_t... OFFSETS>
+void APU::RegisterIOHandlers(std::index_sequence<OFFSETS...>) {
+    (m_memory.MapIOHandler<nullptr, &APU::WriteRegister<REGISTER_START + OFFSETS>>(
+        REGISTER_START + OFFSETS, this, &m_registers[OFFSETS], READ_MASKS[OFFSETS]), ...);
+
+    // NR52 reports the channel status bits
+    m_memory.MapIOHandler<&APU::ReadNR52, &APU::WriteRegister<NR52>>(NR52, this);
+}
+
+void APU::Reset() {
+    m_registers.fill(0);
+    std::copy(POST_BOOT_REGISTERS.begin(), POST_BOOT_REGISTERS.end(), m_registers.begin());
+
+    m_square[0] = {};
+    m_square[1] = {};
+    m_wave = {};
+    m_noise = {};
+    m_noise.lfsr = 0x7FFF;
+    m_sequencer_step = 0;
+
+    m_synced_cycle = m_scheduler.GetCurrentCycle();
+    RestartSynthesis();
+
+    m_scheduler.Schedule(Scheduler::EventType::APU_FRAME_SEQUENCER, FRAME_SEQUENCER_PERIOD);
+
+    spdlog::debug("APU reset");
+}
+
+void APU::SetOutput(SampleRing* ring, u32 sample_rate) {
+    Sync();
+    m_output = ring;
+
+    if (m_output) {
+        for (BandLimitedSynth& synth : m_synth) {
+            synth.SetRates(CLOCK_RATE, sample_rate, MAX_BLOCK_CLOCKS);
+        }
+        const size_t block_samples = static_cast<size_t>(
+            static_cast<u64>(MAX_BLOCK_CLOCKS) * sample_rate / CLOCK_RATE) + 2;
+        m_block_samples.assign(block_samples * 2 * SampleRing::CHANNELS, 0);
+        RestartSynthesis();
+    }
+}
+
+void APU::SetMuted(bool muted) {
+    if (muted == m_muted) return;
+
+    Sync();
+    m_muted = muted;
+
+    if (muted) {
+        m_muted_at = m_synced_cycle;
+    } else if (m_synced_cycle != m_muted_at) {
+        // Resuming from a different point in time: start over
+        RestartSynthesis();
+    }
+}
+
+void APU::SaveState(State& state) const {
+    state = {};
+    state.registers = m_registers;
+    state.square[0] = m_square[0];
+    state.square[1] = m_square[1];
+    state.wave = m_wave;
+    state.noise = m_noise;
+    state.sequencer_step = m_sequencer_step;
+}
+
+void APU::LoadState(const State& state) {
+    m_registers = state.registers;
+    m_square[0] = state.square[0];
+    m_square[1] = state.square[1];
+    m_wave = state.wave;
+    m_noise = state.noise;
+    m_sequencer_step = state.sequencer_step & 7;
+
+    // While muted the caller resumes the stream itself (see SetMuted)
+    m_synced_cycle = m_scheduler.GetCurrentCycle();
+    if (!m_muted) {
+        RestartSynthesis();
+    }
+}
+
+bool APU::IsSynthesizing() const {
+    return m_output != nullptr && !m_muted;
+}
+
+void APU::RestartSynthesis() {
+    const u64 now = m_synced_cycle;
+    m_block_start = now;
+
+    for (BandLimitedSynth& synth : m_synth) {
+        synth.Clear();
+    }
+    for (auto& contribution : m_contribution) {
+        contribution[0] = contribution[1] = 0;
+    }
+
+    // Edges are only tracked while synthesizing; pick the channels up from now
+    m_square[0].next_edge = std::max(m_square[0].next_edge, now);
+    m_square[1].next_edge = std::max(m_square[1].next_edge, now);
+    m_wave.next_edge = std::max(m_wave.next_edge, now);
+    m_noise.next_edge = std::max(m_noise.next_edge, now);
+
+    UpdateAllContributions(now);
+}
+
+void APU::Sync() {
+    const u64 now = m_scheduler.GetCurrentCycle();
+    if (now <= m_synced_cycle) return;
+
+    if (IsSynthesizing()) {
+        // Blocks end at sequencer steps; only a stalled sequencer needs a split
+        while (now - m_block_start > MAX_BLOCK_CLOCKS) {
+            const u64 block_end = m_block_start + FRAME_SEQUENCER_PERIOD;
+            RunChannels(block_end);
+            EndBlock(block_end);
+        }
+        RunChannels(now);
+    }
+
+    m_synced_cycle = now;
+}
+
+void APU::RunChannels(u64 until) {
+    RunSquare(0, until);
+    RunSquare(1, until);
+    RunWave(until);
+    RunNoise(until);
+}
+
+void APU::RunSquare(u32 index, u64 until) {
+    SquareChannel& channel = m_square[index];
+    if (!channel.enabled) {
+        channel.next_edge = std::max(channel.next_edge, until);
+        return;
+    }
+
+    const u32 period = GetSquarePeriod(index);
+    while (channel.next_edge < until) {
+        channel.duty_position = (channel.duty_position + 1) & 7;
+        const u8 level = GetSquareLevel(index);
+        if (level != channel.level) {
+            channel.level = level;
+            UpdateContribution(index, level, channel.next_edge);
+        }
+        channel.next_edge += period;
+    }
+}
+
+void APU::RunWave(u64 until) {
+    if (!m_wave.enabled) {
+        m_wave.next_edge = std::max(m_wave.next_edge, until);
+        return;
+    }
+
+    const u32 period = GetWavePeriod();
+    while (m_wave.next_edge < until) {
+        m_wave.position = (m_wave.position + 1) & 31;
+        const u8 level = GetWaveLevel();
+        if (level != m_wave.level) {
+            m_wave.level = level;
+            UpdateContribution(2, level, m_wave.next_edge);
+        }
+        m_wave.next_edge += period;
+    }
+}
+
+void APU::RunNoise(u64 until) {
+    const u32 period = GetNoisePeriod();
+    if (!m_noise.enabled || period == 0) {
+        m_noise.next_edge = std::max(m_noise.next_edge, until);
+        return;
+    }
+
+    const bool short_mode = (Register(NR43) & 0x08) != 0;
+    while (m_noise.next_edge < until) {
+        const u16 feedback = (m_noise.lfsr ^ (m_noise.lfsr >> 1)) & 1;
+        m_noise.lfsr = static_cast<u16>((m_noise.lfsr >> 1) | (feedback << 14));
+        if (short_mode) {
+            m_noise.lfsr = static_cast<u16>((m_noise.lfsr & ~0x40) | (feedback << 6));
+        }
+
+        const u8 level = GetNoiseLevel();
+        if (level != m_noise.level) {
+            m_noise.level = level;
+            UpdateContribution(3, level, m_noise.next_edge);
+        }
+        m_noise.next_edge += period;
+    }
+}
+
+void APU::UpdateContribution(u32 channel, u8 level, u64 cycle) {
+    if (!IsSynthesizing()) return;
+
+    // NR51: bits 0-3 route channels right, bits 4-7 left; NR50 sets the volumes
+    const u8 panning = Register(NR51);
+    const u8 volume = Register(NR50);
+    const s32 amplitude[2] = {
+        (panning & (0x10 << channel)) ? level * (((volume >> 4) & 7) + 1) * VOLUME_SCALE : 0,
+        (panning & (0x01 << channel)) ? level * ((volume & 7) + 1) * VOLUME_SCALE : 0,
+    };
+
+    const u32 time = static_cast<u32>(cycle - m_block_start);
+    for (u32 side = 0; side < 2; side++) {
+        const s32 delta = amplitude[side] - m_contribution[channel][side];
+        if (delta != 0) {
+            m_synth[side].AddDelta(time, delta);
+            m_contribution[channel][side] = amplitude[side];
+        }
+    }
+}
+
+void APU::UpdateAllContributions(u64 cycle) {
+    // Levels change outside the edges too: volume, enables, DACs and mixing
+    m_square[0].level = GetSquareLevel(0);
+    m_square[1].level = GetSquareLevel(1);
+    m_wave.level = GetWaveLevel();
+    m_noise.level = GetNoiseLevel();
+
+    UpdateContribution(0, m_square[0].level, cycle);
+    UpdateContribution(1, m_square[1].level, cycle);
+    UpdateContribution(2, m_wave.level, cycle);
+    UpdateContribution(3, m_noise.level, cycle);
+}
+
+void APU::EndBlock(u64 cycle) {
+    const u32 block_clocks = static_cast<u32>(cycle - m_block_start);
+    m_synth[0].EndBlock(block_clocks);
+    m_synth[1].EndBlock(block_clocks);
+    m_block_start = cycle;
+
+    const size_t max_frames = m_block_samples.size() / SampleRing::CHANNELS;
+    const size_t frames = m_synth[0].ReadSamples(m_block_samples.data(), max_frames, SampleRing::CHANNELS);
+    m_synth[1].ReadSamples(m_block_samples.data() + 1, max_frames, SampleRing::CHANNELS);
+
+    m_output->Push(m_block_samples.data(), frames);
+}
+
+void APU::OnFrameSequencer() {
+    Sync();
+    const u64 now = m_synced_cycle;
+
+    if (IsPoweredOn()) {
+        // Steps 0, 2, 4, 6: lengths; 2 and 6: sweep; 7: envelopes
+        if ((m_sequencer_step & 1) == 0) ClockLengths();
+        if (m_sequencer_step == 2 || m_sequencer_step == 6) ClockSweep();
+        if (m_sequencer_step == 7) ClockEnvelopes();
+        m_sequencer_step = (m_sequencer_step + 1) & 7;
+
+        UpdateAllContributions(now);
+    }
+
+    if (IsSynthesizing()) {
+        EndBlock(now);
+    }
+
+    m_scheduler.Schedule(Scheduler::EventType::APU_FRAME_SEQUENCER, FRAME_SEQUENCER_PERIOD);
+}
+
+void APU::ClockLengths() {
+    auto clock = [](u16& length, u8& enabled, u8 nrx4) {
+        if ((nrx4 & NRX4_LENGTH_ENABLE) && length > 0 && --length == 0) {
+            enabled = 0;
+        }
+    };
+
+    clock(m_square[0].length, m_square[0].enabled, Register(NR14));
+    clock(m_square[1].length, m_square[1].enabled, Register(NR24));
+    clock(m_wave.length, m_wave.enabled, Register(NR34));
+    clock(m_noise.length, m_noise.enabled, Register(NR44));
+}
+
+void APU::ClockSweep() {
+    SquareChannel& channel = m_square[0];
+    const u8 nr10 = Register(NR10);
+    const u8 period = (nr10 >> 4) & 7;
+
+    if (channel.sweep_timer > 0) channel.sweep_timer--;
+    if (channel.sweep_timer != 0) return;
+
+    channel.sweep_timer = period ? period : 8;
+    if (!channel.sweep_enabled || period == 0) return;
+
+    const u16 frequency = CalculateSweep();
+    if (frequency <= 2047 && (nr10 & 0x07)) {
+        channel.sweep_shadow = frequency;
+        channel.frequency = frequency;
+        Register(NR13) = static_cast<u8>(frequency);
+        Register(NR14) = static_cast<u8>((Register(NR14) & ~0x07) | (frequency >> 8));
+
+        // The new frequency is checked for overflow once more
+        CalculateSweep();
+    }
+}
+
+void APU::ClockEnvelopes() {
+    auto clock = [](u8& volume, u8& timer, u8 nrx2) {
+        const u8 period = nrx2 & 0x07;
+        if (period == 0) return;
+
+        if (timer > 0) timer--;
+        if (timer != 0) return;
+
+        timer = period;
+        if ((nrx2 & 0x08) && volume < 15) {
+            volume++;
+        } else if (!(nrx2 & 0x08) && volume > 0) {
+            volume--;
+        }
+    };
+
+    clock(m_square[0].volume, m_square[0].envelope_timer, Register(NR12));
+    clock(m_square[1].volume, m_square[1].envelope_timer, Register(NR22));
+    clock(m_noise.volume, m_noise.envelope_timer, Register(NR42));
+}
+
+u16 APU::CalculateSweep() {
+    SquareChannel& channel = m_square[0];
+    const u8 nr10 = Register(NR10);
+    const u16 change = channel.sweep_shadow >> (nr10 & 0x07);
+    const u16 frequency = (nr10 & 0x08) ? channel.sweep_shadow - change : channel.sweep_shadow + change;
+
+    if (frequency > 2047) {
+        channel.enabled = 0;
+    }
+    return frequency;
+}
+
+void APU::TriggerSquare(u32 index) {
+    SquareChannel& channel = m_square[index];
+    const u8 nrx2 = Register(SquareRegister(index, NR12));
+
+    channel.enabled = (nrx2 & 0xF8) != 0;
+    if (channel.length == 0) channel.length = 64;
+    channel.volume = nrx2 >> 4;
+    channel.envelope_timer = nrx2 & 0x07;
+    channel.next_edge = m_synced_cycle + GetSquarePeriod(index);
+
+    if (index == 0) {
+        const u8 nr10 = Register(NR10);
+        const u8 period = (nr10 >> 4) & 7;
+        channel.sweep_shadow = channel.frequency;
+        channel.sweep_timer = period ? period : 8;
+        channel.sweep_enabled = period != 0 || (nr10 & 0x07) != 0;
+        if (nr10 & 0x07) {
+            CalculateSweep();
+        }
+    }
+}
+
+void APU::TriggerWave() {
+    m_wave.enabled = (Register(NR30) & 0x80) != 0;
+    if (m_wave.length == 0) m_wave.length = 256;
+    m_wave.position = 0;
+    m_wave.next_edge = m_synced_cycle + GetWavePeriod();
+}
+
+void APU::TriggerNoise() {
+    const u8 nr42 = Register(NR42);
+
+    m_noise.enabled = (nr42 & 0xF8) != 0;
+    if (m_noise.length == 0) m_noise.length = 64;
+    m_noise.volume = nr42 >> 4;
+    m_noise.envelope_timer = nr42 & 0x07;
+    m_noise.lfsr = 0x7FFF;
+    m_noise.next_edge = m_synced_cycle + std::max<u32>(GetNoisePeriod(), 1);
+}
+
+u32 APU::GetSquarePeriod(u32 index) const {
+    return (2048 - m_square[index].frequency) * 4;
+}
+
+u32 APU::GetWavePeriod() const {
+    return (2048 - m_wave.frequency) * 2;
+}
+
+u32 APU::GetNoisePeriod() const {
+    // Shifts of 14 and 15 stop the LFSR
+    const u8 nr43 = Register(NR43);
+    const u8 shift = nr43 >> 4;
+    return shift < 14 ? static_cast<u32>(NOISE_DIVISORS[nr43 & 0x07]) << shift : 0;
+}
+
+u8 APU::GetSquareLevel(u32 index) const {
+    const SquareChannel& channel = m_square[index];
+    if (!channel.enabled) return 0;
+
+    const u8 duty = Register(SquareRegister(index, NR11)) >> 6;
+    return ((DUTY_PATTERNS[duty] >> (7 - channel.duty_position)) & 1) ? channel.volume : 0;
+}
+
+u8 APU::GetWaveLevel() const {
+    const u8 volume_code = (Register(NR32) >> 5) & 0x03;
+    if (!m_wave.enabled || volume_code == 0) return 0;
+
+    // High nibble first; volume codes 1-3 shift by 0-2
+    const u8 byte = Register(WAVE_RAM + m_wave.position / 2);
+    const u8 sample = (m_wave.position & 1) ? (byte & 0x0F) : (byte >> 4);
+    return sample >> (volume_code - 1);
+}
+
+u8 APU::GetNoiseLevel() const {
+    if (!m_noise.enabled) return 0;
+    return (m_noise.lfsr & 1) ? 0 : m_noise.volume;
+}
+
+u8 APU::GetStatus() const {
+    return static_cast<u8>((Register(NR52) & 0x80) | 0x70 |
+                           (m_square[0].enabled ? 0x01 : 0) |
+                           (m_square[1].enabled ? 0x02 : 0) |
+                           (m_wave.enabled ? 0x04 : 0) |
+                           (m_noise.enabled ? 0x08 : 0));
+}
+
+void APU::PowerOff() {
+    // Every register up to NR51 is cleared; wave RAM survives
+    std::fill(m_registers.begin(), m_registers.begin() + (NR52 - REGISTER_START), 0);
+    m_square[0].enabled = 0;
+    m_square[1].enabled = 0;
+    m_wave.enabled = 0;
+    m_noise.enabled = 0;
+}
+
+u8 APU::ReadNR52() {
+    Sync();
+    return GetStatus();
+}
+
+void APU::WriteRegister(u16 address, u8 value) {
+    Sync();
+
+    if (address == NR52) {
+        const bool power = (value & 0x80) != 0;
+        if (!power && IsPoweredOn()) {
+            PowerOff();
+        } else if (power && !IsPoweredOn()) {
+            m_sequencer_step = 0;
+        }
+        Register(NR52) = value & 0x80;
+        UpdateAllContributions(m_synced_cycle);
+        return;
+    }
+
+    if (address >= WAVE_RAM) {
+        Register(address) = value;
+        return;
+    }
+
+    // The other registers ignore writes while powered off
+    if (!IsPoweredOn() || address > NR52) return;
+    Register(address) = value;
+
+    switch (address) {
+        case NR11: m_square[0].length = 64 - (value & 0x3F); break;
+        case NR21: m_square[1].length = 64 - (value & 0x3F); break;
+        case NR31: m_wave.length = 256 - value; break;
+        case NR41: m_noise.length = 64 - (value & 0x3F); break;
+
+        // Clearing the top five envelope bits turns the DAC (and channel) off
+        case NR12: if ((value & 0xF8) == 0) m_square[0].enabled = 0; break;
+        case NR22: if ((value & 0xF8) == 0) m_square[1].enabled = 0; break;
+        case NR42: if ((value & 0xF8) == 0) m_noise.enabled = 0; break;
+        case NR30: if ((value & 0x80) == 0) m_wave.enabled = 0; break;
+
+        case NR13:
+        case NR14:
+            m_square[0].frequency = static_cast<u16>(Register(NR13) | ((Register(NR14) & 0x07) << 8));
+            if (address == NR14 && (value & NRX4_TRIGGER)) TriggerSquare(0);
+            break;
+
+        case NR23:
+        case NR24:
+            m_square[1].frequency = static_cast<u16>(Register(NR23) | ((Register(NR24) & 0x07) << 8));
+            if (address == NR24 && (value & NRX4_TRIGGER)) TriggerSquare(1);
+            break;
+
+        case NR33:
+        case NR34:
+            m_wave.frequency = static_cast<u16>(Register(NR33) | ((Register(NR34) & 0x07) << 8));
+            if (address == NR34 && (value & NRX4_TRIGGER)) TriggerWave();
+            break;
+
+        case NR44:
+            if (value & NRX4_TRIGGER) TriggerNoise();
+            break;
+
+        default:
+            break;
+    }
+
+    UpdateAllContributions(m_synced_cycle);
+}
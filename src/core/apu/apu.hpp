@@ -0,0 +1,154 @@
+#pragma once
+#include "../types.hpp"
+#include "../memory/memory.hpp"
+#include "../scheduler/scheduler.hpp"
+#include "band_limited_synth.hpp"
+#include "sample_ring.hpp"
+#include <utility>
+
+// DMG audio: two square channels (the first with a frequency sweep), a wave
+// channel and a noise channel.
+//
+// The APU catches up lazily: register accesses and the 512 Hz frame sequencer
+// event (APU_FRAME_SEQUENCER) run the channels from the last sync point to
+// now, stepping each one edge to edge and feeding its level changes to a
+// band-limited synthesizer. Every sequencer step closes a block of samples
+// and pushes it to the output ring. Without an output the channels still
+// keep their register-visible state (lengths, envelopes, sweep) but skip
+// synthesis, so headless runs pay for nine events per frame and nothing else.
+class APU {
+public:
+    static constexpr u32 CLOCK_RATE = 4194304;
+    static constexpr u32 FRAME_SEQUENCER_PERIOD = CLOCK_RATE / 512;
+
+    APU(Memory& memory, Scheduler& scheduler);
+    ~APU() = default;
+
+    void Reset();
+
+    // Send audio to ring at sample_rate Hz, or stop producing it (nullptr).
+    // The ring is not owned and must outlive the APU or the next call.
+    void SetOutput(SampleRing* ring, u32 sample_rate);
+    bool HasOutput() const { return m_output != nullptr; }
+
+    // Keep emulating but discard audio (speculative run-ahead frames).
+    // Unmuting at the cycle the mute started continues the stream seamlessly.
+    void SetMuted(bool muted);
+
+    struct SquareChannel {
+        u64 next_edge;       // Absolute cycle of the next duty step
+        u16 frequency;
+        u16 length;
+        u8 duty_position;
+        u8 volume;
+        u8 envelope_timer;
+        u8 level;            // Current digital output (0-15)
+        u8 enabled;
+        // Sweep (channel 1 only)
+        u16 sweep_shadow;
+        u8 sweep_timer;
+        u8 sweep_enabled;
+    };
+
+    struct WaveChannel {
+        u64 next_edge;
+        u16 frequency;
+        u16 length;
+        u8 position;         // Sample index into wave RAM (0-31)
+        u8 level;
+        u8 enabled;
+    };
+
+    struct NoiseChannel {
+        u64 next_edge;
+        u16 lfsr;
+        u16 length;
+        u8 volume;
+        u8 envelope_timer;
+        u8 level;
+        u8 enabled;
+    };
+
+    // Save state. Samples still in the synthesizer are not saved; a restore
+    // starts a fresh block.
+    struct State {
+        std::array<u8, 0x30> registers;  // 0xFF10-0xFF3F (incl. wave RAM)
+        SquareChannel square[2];
+        WaveChannel wave;
+        NoiseChannel noise;
+        u8 sequencer_step;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
+
+private:
+    static constexpr u16 REGISTER_START = 0xFF10;
+    static constexpr u16 REGISTER_COUNT = 0x30;
+    static constexpr u32 MAX_BLOCK_CLOCKS = FRAME_SEQUENCER_PERIOD * 2;
+    static constexpr s32 VOLUME_SCALE = 64;  // 4 channels x 15 x 8 x 64 fits s16
+
+    Memory& m_memory;
+    Scheduler& m_scheduler;
+
+    std::array<u8, REGISTER_COUNT> m_registers;  // Raw register/wave RAM bytes
+    SquareChannel m_square[2];
+    WaveChannel m_wave;
+    NoiseChannel m_noise;
+    u8 m_sequencer_step;
+
+    // Synthesis
+    SampleRing* m_output;
+    bool m_muted;
+    u64 m_muted_at;                     // Cycle SetMuted(true) was called at
+    u64 m_block_start;                  // Cycle of the synthesizer's time 0
+    u64 m_synced_cycle;                 // Channels are caught up to here
+    BandLimitedSynth m_synth[2];        // Left, right
+    s32 m_contribution[4][2];           // Amplitude each channel last added per side
+    std::vector<s16> m_block_samples;   // Interleaved stereo scratch for one block
+
+    u8& Register(u16 address) { return m_registers[address - REGISTER_START]; }
+    u8 Register(u16 address) const { return m_registers[address - REGISTER_START]; }
+    bool IsPoweredOn() const { return (Register(0xFF26) & 0x80) != 0; }
+    bool IsSynthesizing() const;
+
+    // Start a fresh synthesizer block at the synced cycle
+    void RestartSynthesis();
+
+    // Catch channels (and synthesis) up to the scheduler clock
+    void Sync();
+    void RunChannels(u64 until);
+    void RunSquare(u32 index, u64 until);
+    void RunWave(u64 until);
+    void RunNoise(u64 until);
+    void UpdateContribution(u32 channel, u8 level, u64 cycle);
+    void UpdateAllContributions(u64 cycle);
+    void EndBlock(u64 cycle);
+
+    // Frame sequencer: lengths (256 Hz), sweep (128 Hz), envelopes (64 Hz)
+    void OnFrameSequencer();
+    void ClockLengths();
+    void ClockSweep();
+    void ClockEnvelopes();
+
+    u16 CalculateSweep();
+    void TriggerSquare(u32 index);
+    void TriggerWave();
+    void TriggerNoise();
+    u32 GetSquarePeriod(u32 index) const;
+    u32 GetWavePeriod() const;
+    u32 GetNoisePeriod() const;
+    u8 GetSquareLevel(u32 index) const;
+    u8 GetWaveLevel() const;
+    u8 GetNoiseLevel() const;
+    u8 GetStatus() const;
+    void PowerOff();
+
+    // I/O register handlers (one instantiation per address)
+    template <size_t... OFFSETS>
+    void RegisterIOHandlers(std::index_sequence<OFFSETS...>);
+    template <u16 ADDRESS>
+    void WriteRegister(u8 value) { WriteRegister(ADDRESS, value); }
+    void WriteRegister(u16 address, u8 value);
+    u8 ReadNR52();
+};
@@ -0,0 +1,95 @@
+#include "band_limited_synth.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+void BandLimitedSynth::SetRates(u32 clock_rate, u32 sample_rate, u32 max_block_clocks) {
+    m_factor = ((static_cast<u64>(sample_rate) << FRAC_BITS) + clock_rate / 2) / clock_rate;
+
+    // Room for two blocks of samples plus the kernel tail of the last step
+    const size_t block_samples = static_cast<size_t>((static_cast<u64>(max_block_clocks) * m_factor) >> FRAC_BITS) + 1;
+    m_buffer.assign(block_samples * 2 + KERNEL_WIDTH, 0);
+
+    BuildKernel();
+    Clear();
+}
+
+void BandLimitedSynth::Clear() {
+    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    m_offset = 0;
+    m_samples_available = 0;
+    m_integrator = 0;
+}
+
+void BandLimitedSynth::BuildKernel() {
+    // Blackman-windowed sinc, cut off a little below Nyquist
+    constexpr double CUTOFF = 0.9;
+    constexpr double PI = std::numbers::pi;
+
+    for (u32 phase = 0; phase < PHASES; phase++) {
+        const double fraction = static_cast<double>(phase) / PHASES;
+
+        double taps[KERNEL_WIDTH];
+        double sum = 0.0;
+        for (u32 tap = 0; tap < KERNEL_WIDTH; tap++) {
+            const double x = static_cast<double>(tap) - (HALF_WIDTH - 1) - fraction;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(PI * CUTOFF * x) / (PI * CUTOFF * x);
+            const double window = std::abs(x) >= HALF_WIDTH ? 0.0 :
+                0.42 + 0.5 * std::cos(PI * x / HALF_WIDTH) + 0.08 * std::cos(2.0 * PI * x / HALF_WIDTH);
+            taps[tap] = sinc * window;
+            sum += taps[tap];
+        }
+
+        // Normalize so a step of d always integrates to exactly d
+        s32 total = 0;
+        u32 peak = 0;
+        for (u32 tap = 0; tap < KERNEL_WIDTH; tap++) {
+            m_kernel[phase][tap] = static_cast<s32>(std::lround(taps[tap] / sum * (1 << KERNEL_BITS)));
+            total += m_kernel[phase][tap];
+            if (m_kernel[phase][tap] > m_kernel[phase][peak]) peak = tap;
+        }
+        m_kernel[phase][peak] += (1 << KERNEL_BITS) - total;
+    }
+}
+
+void BandLimitedSynth::AddDelta(u32 clock_time, s32 delta) {
+    const u64 position = m_offset + clock_time * m_factor;
+    const size_t index = static_cast<size_t>(position >> FRAC_BITS);
+    const u32 phase = static_cast<u32>(position >> (FRAC_BITS - PHASE_BITS)) & (PHASES - 1);
+
+    if (UNLIKELY(index + KERNEL_WIDTH > m_buffer.size())) return;
+
+    s32* out = m_buffer.data() + index;
+    const s32* kernel = m_kernel[phase];
+    for (u32 tap = 0; tap < KERNEL_WIDTH; tap++) {
+        out[tap] += kernel[tap] * delta;
+    }
+}
+
+void BandLimitedSynth::EndBlock(u32 block_clocks) {
+    m_offset += block_clocks * m_factor;
+    m_samples_available = static_cast<size_t>(m_offset >> FRAC_BITS);
+}
+
+size_t BandLimitedSynth::ReadSamples(s16* out, size_t count, size_t stride) {
+    const size_t samples = std::min(count, m_samples_available);
+
+    s64 integrator = m_integrator;
+    for (size_t i = 0; i < samples; i++) {
+        integrator += m_buffer[i];
+        const s64 sample = integrator >> KERNEL_BITS;
+        out[i * stride] = static_cast<s16>(std::clamp<s64>(sample, -32768, 32767));
+        integrator -= sample << (KERNEL_BITS - BASS_SHIFT);
+    }
+    m_integrator = integrator;
+
+    // Shift the unread samples and the pending kernel tails to the front
+    const size_t remaining = m_samples_available - samples + KERNEL_WIDTH;
+    std::memmove(m_buffer.data(), m_buffer.data() + samples, remaining * sizeof(s32));
+    std::fill(m_buffer.begin() + remaining, m_buffer.begin() + remaining + samples, 0);
+
+    m_offset -= static_cast<u64>(samples) << FRAC_BITS;
+    m_samples_available -= samples;
+    return samples;
+}
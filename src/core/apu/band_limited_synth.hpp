@@ -0,0 +1,49 @@
+#pragma once
+#include "../types.hpp"
+#include <vector>
+
+// Band-limited step synthesizer. The APU reports each change of a channel's
+// output level as an amplitude step at a clock timestamp; every step is added
+// as a windowed-sinc kernel at its exact sub-sample position, so the square
+// and noise edges come out without aliasing at any output rate. Ending a block
+// integrates the steps into samples (with a DC-blocking high-pass).
+//
+// Storage is allocated once in SetRates; AddDelta/EndBlock/ReadSamples never
+// allocate.
+class BandLimitedSynth {
+public:
+    static constexpr u32 HALF_WIDTH = 8;          // Kernel taps on each side
+    static constexpr u32 PHASE_BITS = 5;          // 32 sub-sample positions
+
+    // max_block_clocks bounds the span of one block
+    void SetRates(u32 clock_rate, u32 sample_rate, u32 max_block_clocks);
+    void Clear();
+
+    // Add an amplitude step at clock_time (relative to the block start)
+    void AddDelta(u32 clock_time, s32 delta);
+
+    // Close the block after block_clocks clocks; its samples become readable
+    void EndBlock(u32 block_clocks);
+
+    size_t GetSamplesAvailable() const { return m_samples_available; }
+
+    // Move up to count finished samples to out (stride apart, for interleaving)
+    size_t ReadSamples(s16* out, size_t count, size_t stride);
+
+private:
+    static constexpr u32 PHASES = 1u << PHASE_BITS;
+    static constexpr u32 KERNEL_WIDTH = HALF_WIDTH * 2;
+    static constexpr u32 KERNEL_BITS = 15;        // Kernel taps sum to 1 << KERNEL_BITS
+    static constexpr u32 FRAC_BITS = 32;          // Fixed-point sample position
+    static constexpr u32 BASS_SHIFT = 9;          // High-pass corner (~15 Hz at 48 kHz)
+
+    s32 m_kernel[PHASES][KERNEL_WIDTH] = {};
+
+    u64 m_factor = 0;        // Output samples per clock, FRAC_BITS fixed point
+    u64 m_offset = 0;        // Position of the block start
+    std::vector<s32> m_buffer;
+    size_t m_samples_available = 0;
+    s64 m_integrator = 0;
+
+    void BuildKernel();
+};
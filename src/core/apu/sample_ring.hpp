@@ -0,0 +1,73 @@
+#pragma once
+#include "../types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of interleaved stereo s16
+// frames. The emulation thread pushes finished audio blocks and the audio
+// callback pops them; neither side locks or allocates. A full ring drops the
+// newest frames, an empty one leaves the callback to pad with silence.
+class SampleRing {
+public:
+    static constexpr size_t CHANNELS = 2;
+
+    explicit SampleRing(size_t capacity_frames)
+        : m_capacity(std::bit_ceil(std::max<size_t>(capacity_frames, 2)))
+        , m_buffer(m_capacity * CHANNELS, 0) {
+    }
+
+    // Producer: returns the number of frames stored
+    size_t Push(const s16* frames, size_t count) {
+        const size_t write = m_write.load(std::memory_order_relaxed);
+        const size_t read = m_read.load(std::memory_order_acquire);
+        count = std::min(count, m_capacity - (write - read));
+
+        WriteFrames(frames, write, count);
+        m_write.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: returns the number of frames copied to frames
+    size_t Pop(s16* frames, size_t count) {
+        const size_t read = m_read.load(std::memory_order_relaxed);
+        const size_t write = m_write.load(std::memory_order_acquire);
+        count = std::min(count, write - read);
+
+        ReadFrames(frames, read, count);
+        m_read.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Frames buffered; exact on either side, approximate from other threads
+    size_t GetAvailable() const {
+        return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+
+    size_t GetCapacity() const { return m_capacity; }
+
+private:
+    size_t m_capacity;  // Frames, power of two
+    std::vector<s16> m_buffer;
+
+    // Counters only grow; the index is the counter modulo the capacity
+    alignas(64) std::atomic<size_t> m_write{0};
+    alignas(64) std::atomic<size_t> m_read{0};
+
+    // A span of the ring is at most two runs: to the end of the buffer, then
+    // from its start
+    void WriteFrames(const s16* frames, size_t position, size_t count) {
+        const size_t start = position & (m_capacity - 1);
+        const size_t first = std::min(count, m_capacity - start);
+        std::copy_n(frames, first * CHANNELS, m_buffer.data() + start * CHANNELS);
+        std::copy_n(frames + first * CHANNELS, (count - first) * CHANNELS, m_buffer.data());
+    }
+
+    void ReadFrames(s16* frames, size_t position, size_t count) const {
+        const size_t start = position & (m_capacity - 1);
+        const size_t first = std::min(count, m_capacity - start);
+        std::copy_n(m_buffer.data() + start * CHANNELS, first * CHANNELS, frames);
+        std::copy_n(m_buffer.data(), (count - first) * CHANNELS, frames + first * CHANNELS);
+    }
+};
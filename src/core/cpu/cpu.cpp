@@ -1,5 +1,54 @@
 #include "cpu.hpp"
-#include <spdlog/spdlog.h>
+#include "../log.hpp"
+#include <algorithm>
+
+namespace {
+
+// Instruction lengths in bytes, matching what each handler fetches
+constexpr std::array<u8, 256> MakeOpcodeLengths() {
+    std::array<u8, 256> lengths{};
+    lengths.fill(1);
+
+    for (u8 opcode : {0x06, 0x0E, 0x16, 0x1E, 0x26, 0x2E, 0x36, 0x3E,   // LD r,n
+                      0x18, 0x20, 0x28, 0x30, 0x38,                     // JR
+                      0xC6, 0xCE, 0xD6, 0xDE, 0xE6, 0xEE, 0xF6, 0xFE,   // ALU A,n
+                      0xE0, 0xF0, 0xE8, 0xF8, 0xCB}) {
+        lengths[opcode] = 2;
+    }
+
+    for (u8 opcode : {0x01, 0x11, 0x21, 0x31, 0x08,                     // LD rr,nn / LD (nn),SP
+                      0xC2, 0xC3, 0xCA, 0xD2, 0xDA,                     // JP
+                      0xC4, 0xCC, 0xCD, 0xD4, 0xDC,                     // CALL
+                      0xEA, 0xFA}) {
+        lengths[opcode] = 3;
+    }
+
+    return lengths;
+}
+
+// Instructions that end a block: control flow, HALT/STOP, and EI. Any other
+// instruction that changes IF/IE (or a write that raises an interrupt) ends
+// the block from ExecuteBlock, so the interrupt is serviced at the next
+// instruction boundary
+constexpr std::array<bool, 256> MakeBlockTerminators() {
+    std::array<bool, 256> terminators{};
+
+    for (u8 opcode : {0x18, 0x20, 0x28, 0x30, 0x38,                     // JR
+                      0xC2, 0xC3, 0xCA, 0xD2, 0xDA, 0xE9,               // JP
+                      0xC4, 0xCC, 0xCD, 0xD4, 0xDC,                     // CALL
+                      0xC0, 0xC8, 0xC9, 0xD0, 0xD8, 0xD9,               // RET/RETI
+                      0xC7, 0xCF, 0xD7, 0xDF, 0xE7, 0xEF, 0xF7, 0xFF,   // RST
+                      0x76, 0x10, 0xFB}) {                              // HALT, STOP, EI
+        terminators[opcode] = true;
+    }
+
+    return terminators;
+}
+
+constexpr std::array<u8, 256> s_opcode_lengths = MakeOpcodeLengths();
+constexpr std::array<bool, 256> s_block_terminators = MakeBlockTerminators();
+
+}  // namespace
 
 CPU::CPU(Memory& memory, Scheduler& scheduler)
     : m_memory(memory)
@@ -7,7 +56,9 @@ CPU::CPU(Memory& memory, Scheduler& scheduler)
     , m_ime(false)
     , m_halted(false)
     , m_stopped(false)
-    , m_cycles(0) {
+    , m_cycles(0)
+    , m_operand(0)
+    , m_uncached{} {
     Reset();
 }
 
@@ -25,37 +76,260 @@ void CPU::Reset() {
     m_stopped = false;
     m_cycles = 0;
 
+    FlushBlockCache();
+
     spdlog::debug("CPU reset");
 }
 
 u32 CPU::Step() {
+    return StepUntil(m_scheduler.GetNextEventCycle());
+}
+
+void CPU::RunUntil(u64 target_cycle) {
+    // Registers stay in m_regs (every handler works on them); the loop only
+    // skips the per-call bookkeeping of GameBoy::Step. The next event is
+    // re-read every block since I/O writes may schedule one.
+    for (;;) {
+        const u64 deadline = std::min(target_cycle, m_scheduler.GetNextEventCycle());
+        if (m_scheduler.GetCurrentCycle() >= deadline) break;
+
+        StepUntil(deadline);
+    }
+}
+
+u32 CPU::StepUntil(u64 wake_cycle) {
     m_cycles = 0;
 
-    // Check if we should wake from HALT
-    // HALT wakes up when any interrupt is pending (IE & IF != 0), regardless of IME
-    if (m_halted) {
-        u8 if_reg = m_memory.Read(0xFF0F);
-        u8 ie_reg = m_memory.Read(0xFFFF);
-        if ((if_reg & ie_reg) != 0) {
+    // Interrupts are only re-evaluated when IF, IE, IME or HALT changed
+    if (UNLIKELY(m_memory.HasInterruptStateChanged())) {
+        m_memory.ClearInterruptStateChanged();
+
+        // HALT/STOP wake up when any interrupt is pending (IE & IF != 0), regardless of IME
+        if ((m_halted || m_stopped) && m_memory.GetPendingInterrupts() != 0) {
             m_halted = false;
-            spdlog::trace("Waking from HALT, IF={:02X} IE={:02X}", if_reg, ie_reg);
-        } else {
-            // Still halted, consume cycles and return
-            m_cycles = 4;
-            return m_cycles;
+            m_stopped = false;
+            LOG_TRACE("Waking from HALT, pending={:02X}", m_memory.GetPendingInterrupts());
+            TRACE_RECORD(m_trace, TraceEvent::HALT_WAKE, m_memory.GetPendingInterrupts());
         }
+
+        // Handle interrupts (only if IME is set)
+        ServiceInterrupts();
     }
 
-    // Handle interrupts (only if IME is set)
-    ServiceInterrupts();
+    if (UNLIKELY(m_halted || m_stopped)) {
+        // Only a scheduler event can raise an interrupt now, so skip straight to it
+        m_cycles += IdleCycles(wake_cycle);
+        m_scheduler.Advance(m_cycles);
+        return m_cycles;
+    }
 
     // Fetch and execute
-    u8 opcode = FetchByte();
-    ExecuteInstruction(opcode);
+    ExecuteBlock(wake_cycle);
 
     return m_cycles;
 }
 
+u32 CPU::IdleCycles(u64 wake_cycle) const {
+    const u64 now = m_scheduler.GetCurrentCycle();
+    const u64 remaining = wake_cycle > now ? wake_cycle - now : 0;
+
+    // Whole M-cycles, and bounded so Step() returns even with nothing scheduled
+    const u64 cycles = std::min<u64>((remaining + 3) & ~3ull, MAX_IDLE_CYCLES);
+    return static_cast<u32>(std::max<u64>(cycles, 4));
+}
+
+void CPU::ExecuteBlock(u64 deadline) {
+    const u16 pc = m_regs.pc;
+    const u8 page = pc >> 8;
+
+    // ROM and page-mapped RAM are cached; anything else (HRAM, I/O, OAM) is
+    // decoded one instruction at a time so it can never run stale
+    const DecodedInstruction* instructions = nullptr;
+    u16 count = 0;
+
+    if (pc <= Memory::ROM_BANK_N_END || m_memory.IsPageMapped(page)) {
+        const Block& block = GetBlock(pc);
+        instructions = m_block_instructions.data() + block.first;
+        count = block.count;
+        PERF_COUNT(m_perf.blocks);
+    }
+
+    // Also covers a first instruction that straddles the block's page
+    if (UNLIKELY(count == 0)) {
+        m_uncached = DecodeInstruction(pc);
+        instructions = &m_uncached;
+        count = 1;
+        PERF_COUNT(m_perf.uncached_instructions);
+    }
+
+    // A write to the block's own page (or an MBC bank switch under it) bumps
+    // the page generation; stop there so the rest is re-decoded
+    const u32& generation = m_memory.GetCodeGeneration(page);
+    const u32 entry_generation = generation;
+
+    // The scheduler clock is brought up to each instruction's first cycle,
+    // so the I/O it touches (DIV/TIMA, LY/STAT, the DMA lockout) sees the
+    // current time. The block ends early once an event is due; an I/O write
+    // may have scheduled one sooner than the deadline.
+    u32 advanced = 0;
+
+    for (u16 i = 0; i < count; i++) {
+        m_scheduler.Advance(m_cycles - advanced);
+        advanced = m_cycles;
+        if (UNLIKELY(i != 0 && m_scheduler.GetCurrentCycle() >=
+                               std::min(deadline, m_scheduler.GetNextEventCycle()))) {
+            return;
+        }
+
+        const DecodedInstruction& instruction = instructions[i];
+        PERF_COUNT(m_perf.opcodes[instruction.opcode]);
+#if DMWSS_PERF_COUNTERS
+        if (instruction.opcode == 0xCB) {
+            m_perf.cb_opcodes[instruction.operand & 0xFF]++;
+        }
+#endif
+
+        // Opcode fetch
+        m_cycles += 4;
+        m_regs.pc++;
+
+        m_operand = instruction.operand;
+        instruction.handler(*this);
+
+        if (UNLIKELY(generation != entry_generation)) {
+            break;
+        }
+
+        // Service a newly pending interrupt before the next instruction
+        if (UNLIKELY(m_memory.HasInterruptStateChanged())) {
+            break;
+        }
+    }
+
+    m_scheduler.Advance(m_cycles - advanced);
+}
+
+const CPU::Block& CPU::GetBlock(u16 pc) {
+    const bool banked = pc >= Memory::ROM_BANK_N_START && pc <= Memory::ROM_BANK_N_END;
+    const u16 bank = banked ? m_memory.GetROMBank() : 0;
+
+    for (u16 index = m_block_map[pc]; index != 0; index = m_blocks[index].next) {
+        Block& block = m_blocks[index];
+        if (block.bank != bank) continue;
+
+        // RAM-resident code is re-decoded once its page has been written to
+        if (pc > Memory::ROM_BANK_N_END &&
+            block.generation != m_memory.GetCodeGeneration(pc >> 8)) {
+            CompileBlock(block);
+        }
+        return block;
+    }
+
+    if (m_blocks.size() >= MAX_CACHED_BLOCKS ||
+        m_block_instructions.size() >= MAX_CACHED_INSTRUCTIONS) {
+        FlushBlockCache();
+    }
+
+    const u16 index = static_cast<u16>(m_blocks.size());
+    Block& block = m_blocks.emplace_back();
+    block.start_pc = pc;
+    block.bank = bank;
+    block.next = m_block_map[pc];
+    m_block_map[pc] = index;
+
+    CompileBlock(block);
+    return block;
+}
+
+void CPU::CompileBlock(Block& block) {
+    PERF_COUNT(m_perf.block_compiles);
+
+    const u32 start = block.start_pc;
+    const u8 page = static_cast<u8>(start >> 8);
+
+    // Blocks never cross the ROM bank boundaries, and RAM blocks stay within
+    // the single page whose writes invalidate them
+    u32 end;
+    if (start <= Memory::ROM_BANK_0_END) {
+        end = Memory::ROM_BANK_N_START;
+    } else if (start <= Memory::ROM_BANK_N_END) {
+        end = Memory::ROM_BANK_N_END + 1;
+    } else {
+        end = (start & ~0xFFu) + Memory::PAGE_SIZE;
+        block.generation = m_memory.GetCodeGeneration(page);
+        m_memory.ProtectCodePage(page);
+    }
+
+    block.first = static_cast<u32>(m_block_instructions.size());
+    block.count = 0;
+
+    u32 pc = start;
+    while (block.count < MAX_BLOCK_LENGTH) {
+        const DecodedInstruction instruction = DecodeInstruction(static_cast<u16>(pc));
+        if (pc + instruction.length > end) break;
+
+        m_block_instructions.push_back(instruction);
+        block.count++;
+        pc += instruction.length;
+
+        if (s_block_terminators[instruction.opcode]) break;
+    }
+}
+
+CPU::DecodedInstruction CPU::DecodeInstruction(u16 pc) const {
+    DecodedInstruction instruction;
+    instruction.opcode = m_memory.Read(pc);
+    instruction.length = s_opcode_lengths[instruction.opcode];
+    instruction.operand = 0;
+
+    if (instruction.length >= 2) {
+        instruction.operand = m_memory.Read(pc + 1);
+    }
+    if (instruction.length == 3) {
+        instruction.operand |= static_cast<u16>(m_memory.Read(pc + 2)) << 8;
+    }
+
+    instruction.handler = GetHandler(instruction.opcode, static_cast<u8>(instruction.operand));
+
+    return instruction;
+}
+
+void CPU::SaveState(State& state) const {
+    state = {};
+    state.af = m_regs.af;
+    state.bc = m_regs.bc;
+    state.de = m_regs.de;
+    state.hl = m_regs.hl;
+    state.sp = m_regs.sp;
+    state.pc = m_regs.pc;
+    state.ime = m_ime;
+    state.halted = m_halted;
+    state.stopped = m_stopped;
+}
+
+void CPU::LoadState(const State& state) {
+    m_regs.af = state.af & 0xFFF0;
+    m_regs.bc = state.bc;
+    m_regs.de = state.de;
+    m_regs.hl = state.hl;
+    m_regs.sp = state.sp;
+    m_regs.pc = state.pc;
+    m_ime = state.ime != 0;
+    m_halted = state.halted != 0;
+    m_stopped = state.stopped != 0;
+
+    m_memory.MarkInterruptStateChanged();
+}
+
+void CPU::FlushBlockCache() {
+    m_blocks.clear();
+    m_blocks.emplace_back();  // Reserved "no block" entry
+    m_block_instructions.clear();
+    m_block_map.fill(0);
+
+    spdlog::trace("Block cache flushed");
+}
+
 void CPU::RequestInterrupt(u8 interrupt_bit) {
     u8 if_reg = m_memory.Read(0xFF0F);
     m_memory.Write(0xFF0F, if_reg | (1 << interrupt_bit));
@@ -93,329 +367,9 @@ void CPU::ServiceInterrupts() {
 
             m_cycles += 20;  // Interrupt servicing takes 5 M-cycles
 
-            spdlog::trace("Servicing interrupt {}, jumping to 0x{:04X}", i, vector);
+            LOG_TRACE("Servicing interrupt {}, jumping to 0x{:04X}", i, vector);
+            TRACE_RECORD(m_trace, TraceEvent::INTERRUPT_SERVICE, i);
             break;
         }
     }
 }
-
-void CPU::ExecuteInstruction(u8 opcode) {
-    switch (opcode) {
-        // NOP
-        case 0x00: OP_NOP(); break;
-
-        // 16-bit loads
-        case 0x01: OP_LD_rr_nn(m_regs.bc); break;
-        case 0x11: OP_LD_rr_nn(m_regs.de); break;
-        case 0x21: OP_LD_rr_nn(m_regs.hl); break;
-        case 0x31: OP_LD_rr_nn(m_regs.sp); break;
-
-        case 0x08: OP_LD_nn_SP(); break;
-        case 0xF8: OP_LD_HL_SP_e(); break;
-        case 0xF9: OP_LD_SP_HL(); break;
-
-        // 8-bit loads - LD r,n
-        case 0x06: OP_LD_r_n(m_regs.b); break;
-        case 0x0E: OP_LD_r_n(m_regs.c); break;
-        case 0x16: OP_LD_r_n(m_regs.d); break;
-        case 0x1E: OP_LD_r_n(m_regs.e); break;
-        case 0x26: OP_LD_r_n(m_regs.h); break;
-        case 0x2E: OP_LD_r_n(m_regs.l); break;
-        case 0x3E: OP_LD_r_n(m_regs.a); break;
-
-        // LD r,r' (B destination)
-        case 0x40: OP_LD_r_r(m_regs.b, m_regs.b); break;
-        case 0x41: OP_LD_r_r(m_regs.b, m_regs.c); break;
-        case 0x42: OP_LD_r_r(m_regs.b, m_regs.d); break;
-        case 0x43: OP_LD_r_r(m_regs.b, m_regs.e); break;
-        case 0x44: OP_LD_r_r(m_regs.b, m_regs.h); break;
-        case 0x45: OP_LD_r_r(m_regs.b, m_regs.l); break;
-        case 0x46: OP_LD_r_HL(m_regs.b); break;
-        case 0x47: OP_LD_r_r(m_regs.b, m_regs.a); break;
-
-        // LD r,r' (C destination)
-        case 0x48: OP_LD_r_r(m_regs.c, m_regs.b); break;
-        case 0x49: OP_LD_r_r(m_regs.c, m_regs.c); break;
-        case 0x4A: OP_LD_r_r(m_regs.c, m_regs.d); break;
-        case 0x4B: OP_LD_r_r(m_regs.c, m_regs.e); break;
-        case 0x4C: OP_LD_r_r(m_regs.c, m_regs.h); break;
-        case 0x4D: OP_LD_r_r(m_regs.c, m_regs.l); break;
-        case 0x4E: OP_LD_r_HL(m_regs.c); break;
-        case 0x4F: OP_LD_r_r(m_regs.c, m_regs.a); break;
-
-        // LD r,r' (D destination)
-        case 0x50: OP_LD_r_r(m_regs.d, m_regs.b); break;
-        case 0x51: OP_LD_r_r(m_regs.d, m_regs.c); break;
-        case 0x52: OP_LD_r_r(m_regs.d, m_regs.d); break;
-        case 0x53: OP_LD_r_r(m_regs.d, m_regs.e); break;
-        case 0x54: OP_LD_r_r(m_regs.d, m_regs.h); break;
-        case 0x55: OP_LD_r_r(m_regs.d, m_regs.l); break;
-        case 0x56: OP_LD_r_HL(m_regs.d); break;
-        case 0x57: OP_LD_r_r(m_regs.d, m_regs.a); break;
-
-        // LD r,r' (E destination)
-        case 0x58: OP_LD_r_r(m_regs.e, m_regs.b); break;
-        case 0x59: OP_LD_r_r(m_regs.e, m_regs.c); break;
-        case 0x5A: OP_LD_r_r(m_regs.e, m_regs.d); break;
-        case 0x5B: OP_LD_r_r(m_regs.e, m_regs.e); break;
-        case 0x5C: OP_LD_r_r(m_regs.e, m_regs.h); break;
-        case 0x5D: OP_LD_r_r(m_regs.e, m_regs.l); break;
-        case 0x5E: OP_LD_r_HL(m_regs.e); break;
-        case 0x5F: OP_LD_r_r(m_regs.e, m_regs.a); break;
-
-        // LD r,r' (H destination)
-        case 0x60: OP_LD_r_r(m_regs.h, m_regs.b); break;
-        case 0x61: OP_LD_r_r(m_regs.h, m_regs.c); break;
-        case 0x62: OP_LD_r_r(m_regs.h, m_regs.d); break;
-        case 0x63: OP_LD_r_r(m_regs.h, m_regs.e); break;
-        case 0x64: OP_LD_r_r(m_regs.h, m_regs.h); break;
-        case 0x65: OP_LD_r_r(m_regs.h, m_regs.l); break;
-        case 0x66: OP_LD_r_HL(m_regs.h); break;
-        case 0x67: OP_LD_r_r(m_regs.h, m_regs.a); break;
-
-        // LD r,r' (L destination)
-        case 0x68: OP_LD_r_r(m_regs.l, m_regs.b); break;
-        case 0x69: OP_LD_r_r(m_regs.l, m_regs.c); break;
-        case 0x6A: OP_LD_r_r(m_regs.l, m_regs.d); break;
-        case 0x6B: OP_LD_r_r(m_regs.l, m_regs.e); break;
-        case 0x6C: OP_LD_r_r(m_regs.l, m_regs.h); break;
-        case 0x6D: OP_LD_r_r(m_regs.l, m_regs.l); break;
-        case 0x6E: OP_LD_r_HL(m_regs.l); break;
-        case 0x6F: OP_LD_r_r(m_regs.l, m_regs.a); break;
-
-        // LD (HL),r
-        case 0x70: OP_LD_HL_r(m_regs.b); break;
-        case 0x71: OP_LD_HL_r(m_regs.c); break;
-        case 0x72: OP_LD_HL_r(m_regs.d); break;
-        case 0x73: OP_LD_HL_r(m_regs.e); break;
-        case 0x74: OP_LD_HL_r(m_regs.h); break;
-        case 0x75: OP_LD_HL_r(m_regs.l); break;
-        case 0x36: OP_LD_HL_n(); break;
-        case 0x77: OP_LD_HL_r(m_regs.a); break;
-
-        // LD r,r' (A destination)
-        case 0x78: OP_LD_r_r(m_regs.a, m_regs.b); break;
-        case 0x79: OP_LD_r_r(m_regs.a, m_regs.c); break;
-        case 0x7A: OP_LD_r_r(m_regs.a, m_regs.d); break;
-        case 0x7B: OP_LD_r_r(m_regs.a, m_regs.e); break;
-        case 0x7C: OP_LD_r_r(m_regs.a, m_regs.h); break;
-        case 0x7D: OP_LD_r_r(m_regs.a, m_regs.l); break;
-        case 0x7E: OP_LD_r_HL(m_regs.a); break;
-        case 0x7F: OP_LD_r_r(m_regs.a, m_regs.a); break;
-
-        // Special loads
-        case 0x0A: OP_LD_A_BC(); break;
-        case 0x1A: OP_LD_A_DE(); break;
-        case 0xFA: OP_LD_A_nn(); break;
-        case 0x02: OP_LD_BC_A(); break;
-        case 0x12: OP_LD_DE_A(); break;
-        case 0xEA: OP_LD_nn_A(); break;
-        case 0xF0: OP_LDH_A_n(); break;
-        case 0xE0: OP_LDH_n_A(); break;
-        case 0xF2: OP_LD_A_C(); break;
-        case 0xE2: OP_LD_C_A(); break;
-        case 0x22: OP_LDI_HL_A(); break;
-        case 0x2A: OP_LDI_A_HL(); break;
-        case 0x32: OP_LDD_HL_A(); break;
-        case 0x3A: OP_LDD_A_HL(); break;
-
-        // Stack operations
-        case 0xC5: OP_PUSH(m_regs.bc); break;
-        case 0xD5: OP_PUSH(m_regs.de); break;
-        case 0xE5: OP_PUSH(m_regs.hl); break;
-        case 0xF5: OP_PUSH(m_regs.af); break;
-        case 0xC1: OP_POP(m_regs.bc); break;
-        case 0xD1: OP_POP(m_regs.de); break;
-        case 0xE1: OP_POP(m_regs.hl); break;
-        case 0xF1: OP_POP(m_regs.af); break;
-
-        // 8-bit arithmetic - ADD
-        case 0x80: OP_ADD_A_r(m_regs.b); break;
-        case 0x81: OP_ADD_A_r(m_regs.c); break;
-        case 0x82: OP_ADD_A_r(m_regs.d); break;
-        case 0x83: OP_ADD_A_r(m_regs.e); break;
-        case 0x84: OP_ADD_A_r(m_regs.h); break;
-        case 0x85: OP_ADD_A_r(m_regs.l); break;
-        case 0x86: OP_ADD_A_r(ReadByte(m_regs.hl)); break;
-        case 0x87: OP_ADD_A_r(m_regs.a); break;
-        case 0xC6: OP_ADD_A_r(FetchByte()); break;
-
-        // ADC
-        case 0x88: OP_ADC_A_r(m_regs.b); break;
-        case 0x89: OP_ADC_A_r(m_regs.c); break;
-        case 0x8A: OP_ADC_A_r(m_regs.d); break;
-        case 0x8B: OP_ADC_A_r(m_regs.e); break;
-        case 0x8C: OP_ADC_A_r(m_regs.h); break;
-        case 0x8D: OP_ADC_A_r(m_regs.l); break;
-        case 0x8E: OP_ADC_A_r(ReadByte(m_regs.hl)); break;
-        case 0x8F: OP_ADC_A_r(m_regs.a); break;
-        case 0xCE: OP_ADC_A_r(FetchByte()); break;
-
-        // SUB
-        case 0x90: OP_SUB_r(m_regs.b); break;
-        case 0x91: OP_SUB_r(m_regs.c); break;
-        case 0x92: OP_SUB_r(m_regs.d); break;
-        case 0x93: OP_SUB_r(m_regs.e); break;
-        case 0x94: OP_SUB_r(m_regs.h); break;
-        case 0x95: OP_SUB_r(m_regs.l); break;
-        case 0x96: OP_SUB_r(ReadByte(m_regs.hl)); break;
-        case 0x97: OP_SUB_r(m_regs.a); break;
-        case 0xD6: OP_SUB_r(FetchByte()); break;
-
-        // SBC
-        case 0x98: OP_SBC_A_r(m_regs.b); break;
-        case 0x99: OP_SBC_A_r(m_regs.c); break;
-        case 0x9A: OP_SBC_A_r(m_regs.d); break;
-        case 0x9B: OP_SBC_A_r(m_regs.e); break;
-        case 0x9C: OP_SBC_A_r(m_regs.h); break;
-        case 0x9D: OP_SBC_A_r(m_regs.l); break;
-        case 0x9E: OP_SBC_A_r(ReadByte(m_regs.hl)); break;
-        case 0x9F: OP_SBC_A_r(m_regs.a); break;
-        case 0xDE: OP_SBC_A_r(FetchByte()); break;
-
-        // AND
-        case 0xA0: OP_AND_r(m_regs.b); break;
-        case 0xA1: OP_AND_r(m_regs.c); break;
-        case 0xA2: OP_AND_r(m_regs.d); break;
-        case 0xA3: OP_AND_r(m_regs.e); break;
-        case 0xA4: OP_AND_r(m_regs.h); break;
-        case 0xA5: OP_AND_r(m_regs.l); break;
-        case 0xA6: OP_AND_r(ReadByte(m_regs.hl)); break;
-        case 0xA7: OP_AND_r(m_regs.a); break;
-        case 0xE6: OP_AND_r(FetchByte()); break;
-
-        // XOR
-        case 0xA8: OP_XOR_r(m_regs.b); break;
-        case 0xA9: OP_XOR_r(m_regs.c); break;
-        case 0xAA: OP_XOR_r(m_regs.d); break;
-        case 0xAB: OP_XOR_r(m_regs.e); break;
-        case 0xAC: OP_XOR_r(m_regs.h); break;
-        case 0xAD: OP_XOR_r(m_regs.l); break;
-        case 0xAE: OP_XOR_r(ReadByte(m_regs.hl)); break;
-        case 0xAF: OP_XOR_r(m_regs.a); break;
-        case 0xEE: OP_XOR_r(FetchByte()); break;
-
-        // OR
-        case 0xB0: OP_OR_r(m_regs.b); break;
-        case 0xB1: OP_OR_r(m_regs.c); break;
-        case 0xB2: OP_OR_r(m_regs.d); break;
-        case 0xB3: OP_OR_r(m_regs.e); break;
-        case 0xB4: OP_OR_r(m_regs.h); break;
-        case 0xB5: OP_OR_r(m_regs.l); break;
-        case 0xB6: OP_OR_r(ReadByte(m_regs.hl)); break;
-        case 0xB7: OP_OR_r(m_regs.a); break;
-        case 0xF6: OP_OR_r(FetchByte()); break;
-
-        // CP
-        case 0xB8: OP_CP_r(m_regs.b); break;
-        case 0xB9: OP_CP_r(m_regs.c); break;
-        case 0xBA: OP_CP_r(m_regs.d); break;
-        case 0xBB: OP_CP_r(m_regs.e); break;
-        case 0xBC: OP_CP_r(m_regs.h); break;
-        case 0xBD: OP_CP_r(m_regs.l); break;
-        case 0xBE: OP_CP_r(ReadByte(m_regs.hl)); break;
-        case 0xBF: OP_CP_r(m_regs.a); break;
-        case 0xFE: OP_CP_r(FetchByte()); break;
-
-        // INC/DEC 8-bit
-        case 0x04: OP_INC_r(m_regs.b); break;
-        case 0x0C: OP_INC_r(m_regs.c); break;
-        case 0x14: OP_INC_r(m_regs.d); break;
-        case 0x1C: OP_INC_r(m_regs.e); break;
-        case 0x24: OP_INC_r(m_regs.h); break;
-        case 0x2C: OP_INC_r(m_regs.l); break;
-        case 0x34: OP_INC_HL(); break;
-        case 0x3C: OP_INC_r(m_regs.a); break;
-
-        case 0x05: OP_DEC_r(m_regs.b); break;
-        case 0x0D: OP_DEC_r(m_regs.c); break;
-        case 0x15: OP_DEC_r(m_regs.d); break;
-        case 0x1D: OP_DEC_r(m_regs.e); break;
-        case 0x25: OP_DEC_r(m_regs.h); break;
-        case 0x2D: OP_DEC_r(m_regs.l); break;
-        case 0x35: OP_DEC_HL(); break;
-        case 0x3D: OP_DEC_r(m_regs.a); break;
-
-        // 16-bit arithmetic
-        case 0x09: OP_ADD_HL_rr(m_regs.bc); break;
-        case 0x19: OP_ADD_HL_rr(m_regs.de); break;
-        case 0x29: OP_ADD_HL_rr(m_regs.hl); break;
-        case 0x39: OP_ADD_HL_rr(m_regs.sp); break;
-        case 0xE8: OP_ADD_SP_e(); break;
-
-        case 0x03: OP_INC_rr(m_regs.bc); break;
-        case 0x13: OP_INC_rr(m_regs.de); break;
-        case 0x23: OP_INC_rr(m_regs.hl); break;
-        case 0x33: OP_INC_rr(m_regs.sp); break;
-
-        case 0x0B: OP_DEC_rr(m_regs.bc); break;
-        case 0x1B: OP_DEC_rr(m_regs.de); break;
-        case 0x2B: OP_DEC_rr(m_regs.hl); break;
-        case 0x3B: OP_DEC_rr(m_regs.sp); break;
-
-        // Jumps
-        case 0xC3: OP_JP_nn(); break;
-        case 0xE9: OP_JP_HL(); break;
-        case 0xC2: OP_JP_cc_nn(!GetFlag(FLAG_Z)); break;  // JP NZ,nn
-        case 0xCA: OP_JP_cc_nn(GetFlag(FLAG_Z)); break;   // JP Z,nn
-        case 0xD2: OP_JP_cc_nn(!GetFlag(FLAG_C)); break;  // JP NC,nn
-        case 0xDA: OP_JP_cc_nn(GetFlag(FLAG_C)); break;   // JP C,nn
-
-        case 0x18: OP_JR_e(); break;
-        case 0x20: OP_JR_cc_e(!GetFlag(FLAG_Z)); break;  // JR NZ,e
-        case 0x28: OP_JR_cc_e(GetFlag(FLAG_Z)); break;   // JR Z,e
-        case 0x30: OP_JR_cc_e(!GetFlag(FLAG_C)); break;  // JR NC,e
-        case 0x38: OP_JR_cc_e(GetFlag(FLAG_C)); break;   // JR C,e
-
-        // Calls and returns
-        case 0xCD: OP_CALL_nn(); break;
-        case 0xC4: OP_CALL_cc_nn(!GetFlag(FLAG_Z)); break;  // CALL NZ,nn
-        case 0xCC: OP_CALL_cc_nn(GetFlag(FLAG_Z)); break;   // CALL Z,nn
-        case 0xD4: OP_CALL_cc_nn(!GetFlag(FLAG_C)); break;  // CALL NC,nn
-        case 0xDC: OP_CALL_cc_nn(GetFlag(FLAG_C)); break;   // CALL C,nn
-
-        case 0xC9: OP_RET(); break;
-        case 0xC0: OP_RET_cc(!GetFlag(FLAG_Z)); break;  // RET NZ
-        case 0xC8: OP_RET_cc(GetFlag(FLAG_Z)); break;   // RET Z
-        case 0xD0: OP_RET_cc(!GetFlag(FLAG_C)); break;  // RET NC
-        case 0xD8: OP_RET_cc(GetFlag(FLAG_C)); break;   // RET C
-        case 0xD9: OP_RETI(); break;
-
-        // RST
-        case 0xC7: OP_RST(0x00); break;
-        case 0xCF: OP_RST(0x08); break;
-        case 0xD7: OP_RST(0x10); break;
-        case 0xDF: OP_RST(0x18); break;
-        case 0xE7: OP_RST(0x20); break;
-        case 0xEF: OP_RST(0x28); break;
-        case 0xF7: OP_RST(0x30); break;
-        case 0xFF: OP_RST(0x38); break;
-
-        // Rotates and shifts
-        case 0x07: OP_RLCA(); break;
-        case 0x17: OP_RLA(); break;
-        case 0x0F: OP_RRCA(); break;
-        case 0x1F: OP_RRA(); break;
-
-        // Misc
-        case 0x27: OP_DAA(); break;
-        case 0x2F: OP_CPL(); break;
-        case 0x3F: OP_CCF(); break;
-        case 0x37: OP_SCF(); break;
-        case 0x76: OP_HALT(); break;
-        case 0x10: OP_STOP(); break;
-        case 0xF3: OP_DI(); break;
-        case 0xFB: OP_EI(); break;
-
-        // CB prefix - extended instructions
-        case 0xCB: {
-            u8 cb_opcode = FetchByte();
-            ExecuteCBInstruction(cb_opcode);
-            break;
-        }
-
-        default:
-            spdlog::error("Unknown opcode: 0x{:02X} at PC=0x{:04X}", opcode, m_regs.pc - 1);
-            break;
-    }
-}
@@ -2,6 +2,9 @@
 #include "../types.hpp"
 #include "../memory/memory.hpp"
 #include "../scheduler/scheduler.hpp"
+#include <array>
+#include <utility>
+#include <vector>
 
 class CPU {
 public:
@@ -25,9 +28,15 @@ public:
     CPU(Memory& memory, Scheduler& scheduler);
     ~CPU() = default;
 
-    // Execute one instruction
+    // Execute one cached block of instructions (servicing interrupts first),
+    // advancing the scheduler clock as it goes; returns the cycles it took.
+    // The block ends early once the next scheduler event is due.
     u32 Step();
 
+    // Execute blocks back to back until the scheduler clock reaches
+    // target_cycle or the next scheduler event is due
+    void RunUntil(u64 target_cycle);
+
     // Reset CPU to power-on state
     void Reset();
 
@@ -43,9 +52,61 @@ public:
 
     // IME (Interrupt Master Enable)
     bool IsIMEEnabled() const { return m_ime; }
-    void SetIME(bool enabled) { m_ime = enabled; }
+    void SetIME(bool enabled) {
+        m_ime = enabled;
+        m_memory.MarkInterruptStateChanged();
+    }
+
+    // Drop every cached block (e.g. after loading a new ROM)
+    void FlushBlockCache();
+
+#if DMWSS_PERF_COUNTERS
+    const perf::CPUCounters& GetPerfCounters() const { return m_perf; }
+    void ResetPerfCounters() { m_perf = {}; }
+#endif
+
+#if DMWSS_TRACE_RING
+    // Record interrupt service and HALT wake-ups into ring (nullptr: stop)
+    void SetTraceRing(TraceRing* ring) { m_trace = ring; }
+#endif
+
+    // Save state: registers and interrupt/low-power flags. The block cache
+    // survives a restore; Memory retires blocks cached from RAM.
+    struct State {
+        u16 af, bc, de, hl, sp, pc;
+        u8 ime, halted, stopped;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
 
 private:
+    // Cached interpreter: straight-line runs of instructions are decoded once
+    // into blocks and replayed without re-fetching opcodes through Memory
+    using OpcodeHandler = void (*)(CPU& cpu);
+
+    struct DecodedInstruction {
+        OpcodeHandler handler;  // Resolved handler (the CB handler for prefixed instructions)
+        u16 operand;    // Immediate operand bytes (little-endian), or CB opcode
+        u8 opcode;      // Primary opcode (0xCB for prefixed instructions)
+        u8 length;      // Instruction length in bytes, including the opcode
+    };
+
+    struct Block {
+        u16 start_pc;
+        u16 bank;        // ROM bank for blocks in 0x4000-0x7FFF, 0 otherwise
+        u16 next;        // Next block starting at the same PC (other banks), 0 = none
+        u16 count;       // Number of decoded instructions
+        u32 first;       // Index of the first instruction in m_block_instructions
+        u32 generation;  // Code generation of the block's page when decoded
+    };
+
+    static constexpr size_t MAX_BLOCK_LENGTH = 32;          // Instructions per block
+    static constexpr size_t MAX_CACHED_BLOCKS = 0xFFFF;     // Block indices are u16
+    static constexpr size_t MAX_CACHED_INSTRUCTIONS = 1 << 20;
+
+    static constexpr u32 MAX_IDLE_CYCLES = 70224;  // One frame
+
     // Registers with union for efficient 8/16-bit access
     struct Registers {
         union {
@@ -91,6 +152,30 @@ private:
     bool m_halted;     // CPU halted
     bool m_stopped;    // CPU stopped
     u32 m_cycles;      // Cycle counter for current instruction
+    u16 m_operand;     // Remaining immediate bytes of the executing instruction
+
+    // Block cache storage (index 0 of m_blocks is a reserved "no block" entry)
+    std::vector<Block> m_blocks;
+    std::vector<DecodedInstruction> m_block_instructions;
+    std::array<u16, 0x10000> m_block_map;  // Start PC -> first block index
+    DecodedInstruction m_uncached;         // Scratch decode for uncacheable code
+
+#if DMWSS_PERF_COUNTERS
+    perf::CPUCounters m_perf;
+#endif
+
+#if DMWSS_TRACE_RING
+    TraceRing* m_trace = nullptr;
+#endif
+
+    // Block cache helpers
+    // Step(), idling in HALT/STOP until wake_cycle at the latest
+    u32 StepUntil(u64 wake_cycle);
+    u32 IdleCycles(u64 wake_cycle) const;
+    void ExecuteBlock(u64 deadline);
+    const Block& GetBlock(u16 pc);
+    void CompileBlock(Block& block);
+    DecodedInstruction DecodeInstruction(u16 pc) const;
 
     // Flag manipulation helpers
     FORCE_INLINE bool GetFlag(u8 flag) const {
@@ -131,15 +216,19 @@ private:
         m_memory.Write16(address, value);
     }
 
-    // Fetch helpers
+    // Fetch helpers (immediates come from the pre-decoded instruction)
     FORCE_INLINE u8 FetchByte() {
-        return ReadByte(m_regs.pc++);
+        m_cycles += 4;
+        m_regs.pc++;
+        u8 value = static_cast<u8>(m_operand);
+        m_operand >>= 8;
+        return value;
     }
 
     FORCE_INLINE u16 FetchWord() {
-        u16 value = ReadWord(m_regs.pc);
+        m_cycles += 8;
         m_regs.pc += 2;
-        return value;
+        return m_operand;
     }
 
     // Stack operations
@@ -154,16 +243,77 @@ private:
         return value;
     }
 
-    // Instruction implementations (will be in instructions.cpp)
-    void ExecuteInstruction(u8 opcode);
-    void ExecuteCBInstruction(u8 opcode);
+    // Operand encodings used by the opcode bit fields (r, rr and cc)
+    enum class Reg8 : u8 { B, C, D, E, H, L, HL_INDIRECT, A };
+    enum class Reg16 : u8 { BC, DE, HL, SP, AF };
+    enum class Condition : u8 { NZ, Z, NC, C };
+
+    template <Reg8 R>
+    FORCE_INLINE u8& Register8() {
+        static_assert(R != Reg8::HL_INDIRECT, "(HL) is a memory operand");
+        if constexpr (R == Reg8::B) return m_regs.b;
+        else if constexpr (R == Reg8::C) return m_regs.c;
+        else if constexpr (R == Reg8::D) return m_regs.d;
+        else if constexpr (R == Reg8::E) return m_regs.e;
+        else if constexpr (R == Reg8::H) return m_regs.h;
+        else if constexpr (R == Reg8::L) return m_regs.l;
+        else return m_regs.a;
+    }
+
+    template <Reg16 R>
+    FORCE_INLINE u16& Register16() {
+        if constexpr (R == Reg16::BC) return m_regs.bc;
+        else if constexpr (R == Reg16::DE) return m_regs.de;
+        else if constexpr (R == Reg16::HL) return m_regs.hl;
+        else if constexpr (R == Reg16::SP) return m_regs.sp;
+        else return m_regs.af;
+    }
+
+    // r operand of an ALU/BIT instruction: a register or the byte at (HL)
+    template <Reg8 R>
+    FORCE_INLINE u8 ReadOperand8() {
+        if constexpr (R == Reg8::HL_INDIRECT) return ReadByte(m_regs.hl);
+        else return Register8<R>();
+    }
+
+    template <Condition C>
+    FORCE_INLINE bool CheckCondition() const {
+        if constexpr (C == Condition::NZ) return !GetFlag(FLAG_Z);
+        else if constexpr (C == Condition::Z) return GetFlag(FLAG_Z);
+        else if constexpr (C == Condition::NC) return !GetFlag(FLAG_C);
+        else return GetFlag(FLAG_C);
+    }
+
+    // Generated dispatch (instructions.cpp): every opcode gets its own handler,
+    // decoded from the opcode's bit fields at compile time. CB handlers consume
+    // the prefix's second byte themselves, so blocks can point straight at them.
+    template <u8 OPCODE> void Execute();
+    template <u8 OPCODE> void ExecuteCB();
+    template <u8 OPCODE> static void Dispatch(CPU& cpu) { cpu.Execute<OPCODE>(); }
+    template <u8 OPCODE> static void DispatchCB(CPU& cpu);
+
+    template <size_t... OPCODES>
+    static constexpr std::array<OpcodeHandler, 256> MakeOpcodeTable(std::index_sequence<OPCODES...>) {
+        return {&Dispatch<static_cast<u8>(OPCODES)>...};
+    }
+
+    template <size_t... OPCODES>
+    static constexpr std::array<OpcodeHandler, 256> MakeCBTable(std::index_sequence<OPCODES...>) {
+        return {&DispatchCB<static_cast<u8>(OPCODES)>...};
+    }
+
+    static const std::array<OpcodeHandler, 256> s_opcode_table;
+    static const std::array<OpcodeHandler, 256> s_cb_table;
+
+    static OpcodeHandler GetHandler(u8 opcode, u8 cb_opcode) {
+        return opcode == 0xCB ? s_cb_table[cb_opcode] : s_opcode_table[opcode];
+    }
+
+    void OP_INVALID(u8 opcode);
 
     // Opcode handlers - 8-bit loads
-    void OP_LD_r_r(u8& dest, u8 src);
-    void OP_LD_r_n(u8& reg);
-    void OP_LD_r_HL(u8& reg);
-    void OP_LD_HL_r(u8 reg);
-    void OP_LD_HL_n();
+    template <Reg8 DST, Reg8 SRC> void OP_LD_r_r();
+    template <Reg8 R> void OP_LD_r_n();
     void OP_LD_A_BC();
     void OP_LD_A_DE();
     void OP_LD_A_nn();
@@ -180,14 +330,15 @@ private:
     void OP_LDD_A_HL();
 
     // 16-bit loads
-    void OP_LD_rr_nn(u16& reg);
+    template <Reg16 R> void OP_LD_rr_nn();
     void OP_LD_SP_HL();
-    void OP_PUSH(u16 reg);
-    void OP_POP(u16& reg);
+    template <Reg16 R> void OP_PUSH();
+    template <Reg16 R> void OP_POP();
     void OP_LD_nn_SP();
     void OP_LD_HL_SP_e();
 
     // 8-bit arithmetic
+    template <u8 OPERATION> void OP_ALU(u8 value);  // Bits 3-5 of the opcode
     void OP_ADD_A_r(u8 value);
     void OP_ADC_A_r(u8 value);
     void OP_SUB_r(u8 value);
@@ -196,50 +347,49 @@ private:
     void OP_XOR_r(u8 value);
     void OP_OR_r(u8 value);
     void OP_CP_r(u8 value);
-    void OP_INC_r(u8& reg);
-    void OP_DEC_r(u8& reg);
-    void OP_INC_HL();
-    void OP_DEC_HL();
+    template <Reg8 R> void OP_INC_r();
+    template <Reg8 R> void OP_DEC_r();
 
     // 16-bit arithmetic
-    void OP_ADD_HL_rr(u16 value);
-    void OP_INC_rr(u16& reg);
-    void OP_DEC_rr(u16& reg);
+    template <Reg16 R> void OP_ADD_HL_rr();
+    template <Reg16 R> void OP_INC_rr();
+    template <Reg16 R> void OP_DEC_rr();
     void OP_ADD_SP_e();
 
     // Jumps
     void OP_JP_nn();
     void OP_JP_HL();
-    void OP_JP_cc_nn(bool condition);
+    template <Condition C> void OP_JP_cc_nn();
     void OP_JR_e();
-    void OP_JR_cc_e(bool condition);
+    template <Condition C> void OP_JR_cc_e();
 
     // Calls and returns
     void OP_CALL_nn();
-    void OP_CALL_cc_nn(bool condition);
+    template <Condition C> void OP_CALL_cc_nn();
     void OP_RET();
-    void OP_RET_cc(bool condition);
+    template <Condition C> void OP_RET_cc();
     void OP_RETI();
-    void OP_RST(u8 vector);
+    template <u8 VECTOR> void OP_RST();
 
-    // Rotates and shifts
+    // Rotates and shifts (CB forms return the result)
     void OP_RLCA();
     void OP_RLA();
     void OP_RRCA();
     void OP_RRA();
-    void OP_RLC(u8& reg);
-    void OP_RL(u8& reg);
-    void OP_RRC(u8& reg);
-    void OP_RR(u8& reg);
-    void OP_SLA(u8& reg);
-    void OP_SRA(u8& reg);
-    void OP_SRL(u8& reg);
-    void OP_SWAP(u8& reg);
+    template <u8 OPERATION> u8 OP_SHIFT(u8 value);  // Bits 3-5 of the CB opcode
+    u8 OP_RLC(u8 value);
+    u8 OP_RL(u8 value);
+    u8 OP_RRC(u8 value);
+    u8 OP_RR(u8 value);
+    u8 OP_SLA(u8 value);
+    u8 OP_SRA(u8 value);
+    u8 OP_SRL(u8 value);
+    u8 OP_SWAP(u8 value);
 
     // Bit operations
-    void OP_BIT(u8 bit, u8 value);
-    void OP_SET(u8 bit, u8& reg);
-    void OP_RES(u8 bit, u8& reg);
+    template <u8 BIT> void OP_BIT(u8 value);
+    template <u8 BIT> u8 OP_SET(u8 value);
+    template <u8 BIT> u8 OP_RES(u8 value);
 
     // Misc
     void OP_DAA();
@@ -1,30 +1,178 @@
 #include "cpu.hpp"
+#include <spdlog/spdlog.h>
 
 // ============================================================================
-// 8-bit Load Instructions
+// Opcode Decoding
 // ============================================================================
 
-void CPU::OP_LD_r_r(u8& dest, u8 src) {
-    dest = src;
-    m_cycles += 4;
+// Opcodes are decoded from their bit fields the usual way: x = bits 6-7,
+// y = bits 3-5 (p = y >> 1, q = y & 1), z = bits 0-2. Every branch below is
+// resolved at compile time, leaving one straight-line handler per opcode.
+template <u8 OPCODE>
+void CPU::Execute() {
+    constexpr u8 x = OPCODE >> 6;
+    constexpr u8 y = (OPCODE >> 3) & 0x07;
+    constexpr u8 z = OPCODE & 0x07;
+    constexpr u8 p = y >> 1;
+    constexpr u8 q = y & 0x01;
+
+    constexpr Reg8 r_y = static_cast<Reg8>(y);
+    constexpr Reg8 r_z = static_cast<Reg8>(z);
+    constexpr Reg16 rp = static_cast<Reg16>(p);                           // BC, DE, HL, SP
+    constexpr Reg16 rp2 = p == 3 ? Reg16::AF : static_cast<Reg16>(p);     // BC, DE, HL, AF
+    constexpr Condition cc = static_cast<Condition>(y & 0x03);
+
+    if constexpr (x == 0) {
+        if constexpr (z == 0) {
+            if constexpr (y == 0) OP_NOP();
+            else if constexpr (y == 1) OP_LD_nn_SP();
+            else if constexpr (y == 2) OP_STOP();
+            else if constexpr (y == 3) OP_JR_e();
+            else OP_JR_cc_e<cc>();
+        } else if constexpr (z == 1) {
+            if constexpr (q == 0) OP_LD_rr_nn<rp>();
+            else OP_ADD_HL_rr<rp>();
+        } else if constexpr (z == 2) {
+            if constexpr (OPCODE == 0x02) OP_LD_BC_A();
+            else if constexpr (OPCODE == 0x12) OP_LD_DE_A();
+            else if constexpr (OPCODE == 0x22) OP_LDI_HL_A();
+            else if constexpr (OPCODE == 0x32) OP_LDD_HL_A();
+            else if constexpr (OPCODE == 0x0A) OP_LD_A_BC();
+            else if constexpr (OPCODE == 0x1A) OP_LD_A_DE();
+            else if constexpr (OPCODE == 0x2A) OP_LDI_A_HL();
+            else OP_LDD_A_HL();
+        } else if constexpr (z == 3) {
+            if constexpr (q == 0) OP_INC_rr<rp>();
+            else OP_DEC_rr<rp>();
+        } else if constexpr (z == 4) {
+            OP_INC_r<r_y>();
+        } else if constexpr (z == 5) {
+            OP_DEC_r<r_y>();
+        } else if constexpr (z == 6) {
+            OP_LD_r_n<r_y>();
+        } else {
+            if constexpr (y == 0) OP_RLCA();
+            else if constexpr (y == 1) OP_RRCA();
+            else if constexpr (y == 2) OP_RLA();
+            else if constexpr (y == 3) OP_RRA();
+            else if constexpr (y == 4) OP_DAA();
+            else if constexpr (y == 5) OP_CPL();
+            else if constexpr (y == 6) OP_SCF();
+            else OP_CCF();
+        }
+    } else if constexpr (x == 1) {
+        if constexpr (OPCODE == 0x76) OP_HALT();
+        else OP_LD_r_r<r_y, r_z>();
+    } else if constexpr (x == 2) {
+        OP_ALU<y>(ReadOperand8<r_z>());
+    } else {
+        if constexpr (z == 0) {
+            if constexpr (y < 4) OP_RET_cc<cc>();
+            else if constexpr (y == 4) OP_LDH_n_A();
+            else if constexpr (y == 5) OP_ADD_SP_e();
+            else if constexpr (y == 6) OP_LDH_A_n();
+            else OP_LD_HL_SP_e();
+        } else if constexpr (z == 1) {
+            if constexpr (q == 0) OP_POP<rp2>();
+            else if constexpr (p == 0) OP_RET();
+            else if constexpr (p == 1) OP_RETI();
+            else if constexpr (p == 2) OP_JP_HL();
+            else OP_LD_SP_HL();
+        } else if constexpr (z == 2) {
+            if constexpr (y < 4) OP_JP_cc_nn<cc>();
+            else if constexpr (y == 4) OP_LD_C_A();
+            else if constexpr (y == 5) OP_LD_nn_A();
+            else if constexpr (y == 6) OP_LD_A_C();
+            else OP_LD_A_nn();
+        } else if constexpr (z == 3) {
+            if constexpr (y == 0) OP_JP_nn();
+            else if constexpr (y == 1) s_cb_table[static_cast<u8>(m_operand)](*this);
+            else if constexpr (y == 6) OP_DI();
+            else if constexpr (y == 7) OP_EI();
+            else OP_INVALID(OPCODE);
+        } else if constexpr (z == 4) {
+            if constexpr (y < 4) OP_CALL_cc_nn<cc>();
+            else OP_INVALID(OPCODE);
+        } else if constexpr (z == 5) {
+            if constexpr (q == 0) OP_PUSH<rp2>();
+            else if constexpr (p == 0) OP_CALL_nn();
+            else OP_INVALID(OPCODE);
+        } else if constexpr (z == 6) {
+            OP_ALU<y>(FetchByte());
+        } else {
+            OP_RST<y * 8>();
+        }
+    }
 }
 
-void CPU::OP_LD_r_n(u8& reg) {
-    reg = FetchByte();
-    m_cycles += 4;
+// CB opcodes: x selects shift/rotate (by y), BIT, RES or SET (bit y) on r[z]
+template <u8 OPCODE>
+void CPU::ExecuteCB() {
+    constexpr u8 x = OPCODE >> 6;
+    constexpr u8 y = (OPCODE >> 3) & 0x07;
+    constexpr Reg8 r = static_cast<Reg8>(OPCODE & 0x07);
+
+    if constexpr (r == Reg8::HL_INDIRECT) {
+        u8 value = ReadByte(m_regs.hl);
+
+        if constexpr (x == 0) {
+            value = OP_SHIFT<y>(value);
+            WriteByte(m_regs.hl, value);
+            m_cycles += 8;
+        } else if constexpr (x == 1) {
+            OP_BIT<y>(value);
+            m_cycles += 4;
+        } else if constexpr (x == 2) {
+            WriteByte(m_regs.hl, OP_RES<y>(value));
+        } else {
+            WriteByte(m_regs.hl, OP_SET<y>(value));
+        }
+    } else {
+        u8& reg = Register8<r>();
+
+        if constexpr (x == 0) reg = OP_SHIFT<y>(reg);
+        else if constexpr (x == 1) OP_BIT<y>(reg);
+        else if constexpr (x == 2) reg = OP_RES<y>(reg);
+        else reg = OP_SET<y>(reg);
+    }
 }
 
-void CPU::OP_LD_r_HL(u8& reg) {
-    reg = ReadByte(m_regs.hl);
+template <u8 OPCODE>
+void CPU::DispatchCB(CPU& cpu) {
+    // Fetch of the second opcode byte
+    cpu.m_cycles += 4;
+    cpu.m_regs.pc++;
+    cpu.ExecuteCB<OPCODE>();
 }
 
-void CPU::OP_LD_HL_r(u8 reg) {
-    WriteByte(m_regs.hl, reg);
+void CPU::OP_INVALID(u8 opcode) {
+    spdlog::error("Unknown opcode: 0x{:02X} at PC=0x{:04X}", opcode, m_regs.pc - 1);
 }
 
-void CPU::OP_LD_HL_n() {
+// ============================================================================
+// 8-bit Load Instructions
+// ============================================================================
+
+template <CPU::Reg8 DST, CPU::Reg8 SRC>
+void CPU::OP_LD_r_r() {
+    if constexpr (DST == Reg8::HL_INDIRECT) {
+        WriteByte(m_regs.hl, Register8<SRC>());
+    } else if constexpr (SRC == Reg8::HL_INDIRECT) {
+        Register8<DST>() = ReadByte(m_regs.hl);
+    } else {
+        Register8<DST>() = Register8<SRC>();
+        m_cycles += 4;
+    }
+}
+
+template <CPU::Reg8 R>
+void CPU::OP_LD_r_n() {
     u8 value = FetchByte();
-    WriteByte(m_regs.hl, value);
+    if constexpr (R == Reg8::HL_INDIRECT) {
+        WriteByte(m_regs.hl, value);
+    } else {
+        Register8<R>() = value;
+    }
     m_cycles += 4;
 }
 
@@ -96,8 +244,9 @@ void CPU::OP_LDD_A_HL() {
 // 16-bit Load Instructions
 // ============================================================================
 
-void CPU::OP_LD_rr_nn(u16& reg) {
-    reg = FetchWord();
+template <CPU::Reg16 R>
+void CPU::OP_LD_rr_nn() {
+    Register16<R>() = FetchWord();
     m_cycles += 4;
 }
 
@@ -106,15 +255,17 @@ void CPU::OP_LD_SP_HL() {
     m_cycles += 8;
 }
 
-void CPU::OP_PUSH(u16 reg) {
-    Push(reg);
+template <CPU::Reg16 R>
+void CPU::OP_PUSH() {
+    Push(Register16<R>());
     m_cycles += 4;
 }
 
-void CPU::OP_POP(u16& reg) {
-    reg = Pop();
+template <CPU::Reg16 R>
+void CPU::OP_POP() {
+    Register16<R>() = Pop();
     // Special case: F register only uses upper 4 bits
-    if (&reg == &m_regs.af) {
+    if constexpr (R == Reg16::AF) {
         m_regs.f &= 0xF0;
     }
 }
@@ -143,6 +294,18 @@ void CPU::OP_LD_HL_SP_e() {
 // 8-bit Arithmetic Instructions
 // ============================================================================
 
+template <u8 OPERATION>
+void CPU::OP_ALU(u8 value) {
+    if constexpr (OPERATION == 0) OP_ADD_A_r(value);
+    else if constexpr (OPERATION == 1) OP_ADC_A_r(value);
+    else if constexpr (OPERATION == 2) OP_SUB_r(value);
+    else if constexpr (OPERATION == 3) OP_SBC_A_r(value);
+    else if constexpr (OPERATION == 4) OP_AND_r(value);
+    else if constexpr (OPERATION == 5) OP_XOR_r(value);
+    else if constexpr (OPERATION == 6) OP_OR_r(value);
+    else OP_CP_r(value);
+}
+
 void CPU::OP_ADD_A_r(u8 value) {
     u16 result = m_regs.a + value;
     
@@ -225,40 +388,32 @@ void CPU::OP_CP_r(u8 value) {
     m_cycles += 4;
 }
 
-void CPU::OP_INC_r(u8& reg) {
-    reg++;
-    
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_H, (reg & 0x0F) == 0);
-    
-    m_cycles += 4;
-}
-
-void CPU::OP_DEC_r(u8& reg) {
-    reg--;
-    
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_N, true);
-    SetFlag(FLAG_H, (reg & 0x0F) == 0x0F);
-    
-    m_cycles += 4;
-}
-
-void CPU::OP_INC_HL() {
-    u8 value = ReadByte(m_regs.hl);
-    value++;
-    WriteByte(m_regs.hl, value);
+template <CPU::Reg8 R>
+void CPU::OP_INC_r() {
+    u8 value;
+    if constexpr (R == Reg8::HL_INDIRECT) {
+        value = ReadByte(m_regs.hl) + 1;
+        WriteByte(m_regs.hl, value);
+    } else {
+        value = ++Register8<R>();
+        m_cycles += 4;
+    }
     
     SetFlag(FLAG_Z, value == 0);
     SetFlag(FLAG_N, false);
     SetFlag(FLAG_H, (value & 0x0F) == 0);
 }
 
-void CPU::OP_DEC_HL() {
-    u8 value = ReadByte(m_regs.hl);
-    value--;
-    WriteByte(m_regs.hl, value);
+template <CPU::Reg8 R>
+void CPU::OP_DEC_r() {
+    u8 value;
+    if constexpr (R == Reg8::HL_INDIRECT) {
+        value = ReadByte(m_regs.hl) - 1;
+        WriteByte(m_regs.hl, value);
+    } else {
+        value = --Register8<R>();
+        m_cycles += 4;
+    }
     
     SetFlag(FLAG_Z, value == 0);
     SetFlag(FLAG_N, true);
@@ -269,7 +424,9 @@ void CPU::OP_DEC_HL() {
 // 16-bit Arithmetic Instructions
 // ============================================================================
 
-void CPU::OP_ADD_HL_rr(u16 value) {
+template <CPU::Reg16 R>
+void CPU::OP_ADD_HL_rr() {
+    u16 value = Register16<R>();
     u32 result = m_regs.hl + value;
     
     SetFlag(FLAG_N, false);
@@ -280,13 +437,15 @@ void CPU::OP_ADD_HL_rr(u16 value) {
     m_cycles += 8;
 }
 
-void CPU::OP_INC_rr(u16& reg) {
-    reg++;
+template <CPU::Reg16 R>
+void CPU::OP_INC_rr() {
+    Register16<R>()++;
     m_cycles += 8;
 }
 
-void CPU::OP_DEC_rr(u16& reg) {
-    reg--;
+template <CPU::Reg16 R>
+void CPU::OP_DEC_rr() {
+    Register16<R>()--;
     m_cycles += 8;
 }
 
@@ -317,9 +476,10 @@ void CPU::OP_JP_HL() {
     m_cycles += 4;
 }
 
-void CPU::OP_JP_cc_nn(bool condition) {
+template <CPU::Condition C>
+void CPU::OP_JP_cc_nn() {
     u16 address = FetchWord();
-    if (condition) {
+    if (CheckCondition<C>()) {
         m_regs.pc = address;
         m_cycles += 4;
     }
@@ -332,9 +492,10 @@ void CPU::OP_JR_e() {
     m_cycles += 4;
 }
 
-void CPU::OP_JR_cc_e(bool condition) {
+template <CPU::Condition C>
+void CPU::OP_JR_cc_e() {
     s8 offset = static_cast<s8>(FetchByte());
-    if (condition) {
+    if (CheckCondition<C>()) {
         m_regs.pc += offset;
         m_cycles += 4;
     }
@@ -352,9 +513,10 @@ void CPU::OP_CALL_nn() {
     m_cycles += 4;
 }
 
-void CPU::OP_CALL_cc_nn(bool condition) {
+template <CPU::Condition C>
+void CPU::OP_CALL_cc_nn() {
     u16 address = FetchWord();
-    if (condition) {
+    if (CheckCondition<C>()) {
         Push(m_regs.pc);
         m_regs.pc = address;
         m_cycles += 4;
@@ -367,8 +529,9 @@ void CPU::OP_RET() {
     m_cycles += 4;
 }
 
-void CPU::OP_RET_cc(bool condition) {
-    if (condition) {
+template <CPU::Condition C>
+void CPU::OP_RET_cc() {
+    if (CheckCondition<C>()) {
         m_regs.pc = Pop();
         m_cycles += 12;
     }
@@ -378,12 +541,14 @@ void CPU::OP_RET_cc(bool condition) {
 void CPU::OP_RETI() {
     m_regs.pc = Pop();
     m_ime = true;
+    m_memory.MarkInterruptStateChanged();
     m_cycles += 4;
 }
 
-void CPU::OP_RST(u8 vector) {
+template <u8 VECTOR>
+void CPU::OP_RST() {
     Push(m_regs.pc);
-    m_regs.pc = vector;
+    m_regs.pc = VECTOR;
     m_cycles += 16;  // RST takes 4 M-cycles = 16 T-cycles
 }
 
@@ -423,76 +588,97 @@ void CPU::OP_RRA() {
     m_cycles += 4;
 }
 
-void CPU::OP_RLC(u8& reg) {
-    bool carry = (reg & 0x80) != 0;
-    reg = (reg << 1) | (carry ? 1 : 0);
+template <u8 OPERATION>
+u8 CPU::OP_SHIFT(u8 value) {
+    if constexpr (OPERATION == 0) return OP_RLC(value);
+    else if constexpr (OPERATION == 1) return OP_RRC(value);
+    else if constexpr (OPERATION == 2) return OP_RL(value);
+    else if constexpr (OPERATION == 3) return OP_RR(value);
+    else if constexpr (OPERATION == 4) return OP_SLA(value);
+    else if constexpr (OPERATION == 5) return OP_SRA(value);
+    else if constexpr (OPERATION == 6) return OP_SWAP(value);
+    else return OP_SRL(value);
+}
+
+u8 CPU::OP_RLC(u8 value) {
+    bool carry = (value & 0x80) != 0;
+    value = (value << 1) | (carry ? 1 : 0);
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_RL(u8& reg) {
-    bool carry = (reg & 0x80) != 0;
-    reg = (reg << 1) | (GetFlag(FLAG_C) ? 1 : 0);
+u8 CPU::OP_RL(u8 value) {
+    bool carry = (value & 0x80) != 0;
+    value = (value << 1) | (GetFlag(FLAG_C) ? 1 : 0);
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_RRC(u8& reg) {
-    bool carry = (reg & 0x01) != 0;
-    reg = (reg >> 1) | (carry ? 0x80 : 0);
+u8 CPU::OP_RRC(u8 value) {
+    bool carry = (value & 0x01) != 0;
+    value = (value >> 1) | (carry ? 0x80 : 0);
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_RR(u8& reg) {
-    bool carry = (reg & 0x01) != 0;
-    reg = (reg >> 1) | (GetFlag(FLAG_C) ? 0x80 : 0);
+u8 CPU::OP_RR(u8 value) {
+    bool carry = (value & 0x01) != 0;
+    value = (value >> 1) | (GetFlag(FLAG_C) ? 0x80 : 0);
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_SLA(u8& reg) {
-    bool carry = (reg & 0x80) != 0;
-    reg <<= 1;
+u8 CPU::OP_SLA(u8 value) {
+    bool carry = (value & 0x80) != 0;
+    value <<= 1;
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_SRA(u8& reg) {
-    bool carry = (reg & 0x01) != 0;
-    u8 msb = reg & 0x80;
-    reg = (reg >> 1) | msb;
+u8 CPU::OP_SRA(u8 value) {
+    bool carry = (value & 0x01) != 0;
+    u8 msb = value & 0x80;
+    value = (value >> 1) | msb;
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_SRL(u8& reg) {
-    bool carry = (reg & 0x01) != 0;
-    reg >>= 1;
+u8 CPU::OP_SRL(u8 value) {
+    bool carry = (value & 0x01) != 0;
+    value >>= 1;
     
-    SetFlags(reg == 0, false, false, carry);
+    SetFlags(value == 0, false, false, carry);
     m_cycles += 8;
+    return value;
 }
 
-void CPU::OP_SWAP(u8& reg) {
-    reg = ((reg & 0x0F) << 4) | ((reg & 0xF0) >> 4);
+u8 CPU::OP_SWAP(u8 value) {
+    value = ((value & 0x0F) << 4) | ((value & 0xF0) >> 4);
     
-    SetFlags(reg == 0, false, false, false);
+    SetFlags(value == 0, false, false, false);
     m_cycles += 8;
+    return value;
 }
 
 // ============================================================================
 // Bit Operations
 // ============================================================================
 
-void CPU::OP_BIT(u8 bit, u8 value) {
-    bool is_set = (value & (1 << bit)) != 0;
+template <u8 BIT>
+void CPU::OP_BIT(u8 value) {
+    bool is_set = (value & (1 << BIT)) != 0;
     
     SetFlag(FLAG_Z, !is_set);
     SetFlag(FLAG_N, false);
@@ -501,14 +687,16 @@ void CPU::OP_BIT(u8 bit, u8 value) {
     m_cycles += 8;
 }
 
-void CPU::OP_SET(u8 bit, u8& reg) {
-    reg |= (1 << bit);
+template <u8 BIT>
+u8 CPU::OP_SET(u8 value) {
     m_cycles += 8;
+    return value | (1 << BIT);
 }
 
-void CPU::OP_RES(u8 bit, u8& reg) {
-    reg &= ~(1 << bit);
+template <u8 BIT>
+u8 CPU::OP_RES(u8 value) {
     m_cycles += 8;
+    return value & ~(1 << BIT);
 }
 
 // ============================================================================
@@ -573,11 +761,13 @@ void CPU::OP_NOP() {
 
 void CPU::OP_HALT() {
     m_halted = true;
+    m_memory.MarkInterruptStateChanged();  // Wake at once if an interrupt is already pending
     m_cycles += 4;
 }
 
 void CPU::OP_STOP() {
     m_stopped = true;
+    m_memory.MarkInterruptStateChanged();
     m_cycles += 4;
 }
 
@@ -588,81 +778,16 @@ void CPU::OP_DI() {
 
 void CPU::OP_EI() {
     m_ime = true;
+    m_memory.MarkInterruptStateChanged();
     m_cycles += 4;
 }
 
 // ============================================================================
-// CB-prefixed Instructions
+// Dispatch Tables
 // ============================================================================
 
-void CPU::ExecuteCBInstruction(u8 opcode) {
-    u8 reg_index = opcode & 0x07;
-    u8 bit = (opcode >> 3) & 0x07;
-    u8 op_type = (opcode >> 6) & 0x03;
-    
-    // Helper to get register by index
-    auto get_reg = [&]() -> u8& {
-        switch (reg_index) {
-            case 0: return m_regs.b;
-            case 1: return m_regs.c;
-            case 2: return m_regs.d;
-            case 3: return m_regs.e;
-            case 4: return m_regs.h;
-            case 5: return m_regs.l;
-            case 7: return m_regs.a;
-            default: {
-                static u8 dummy = 0;
-                return dummy;
-            }
-        }
-    };
-    
-    // (HL) operations need special handling
-    if (reg_index == 6) {
-        u8 value = ReadByte(m_regs.hl);
-        
-        switch (op_type) {
-            case 0: {  // Rotates/shifts
-                u8 sub_op = (opcode >> 3) & 0x07;
-                switch (sub_op) {
-                    case 0: OP_RLC(value); break;
-                    case 1: OP_RRC(value); break;
-                    case 2: OP_RL(value); break;
-                    case 3: OP_RR(value); break;
-                    case 4: OP_SLA(value); break;
-                    case 5: OP_SRA(value); break;
-                    case 6: OP_SWAP(value); break;
-                    case 7: OP_SRL(value); break;
-                }
-                WriteByte(m_regs.hl, value);
-                m_cycles += 8;
-                break;
-            }
-            case 1: OP_BIT(bit, value); m_cycles += 4; break;
-            case 2: value &= ~(1 << bit); WriteByte(m_regs.hl, value); m_cycles += 8; break;
-            case 3: value |= (1 << bit); WriteByte(m_regs.hl, value); m_cycles += 8; break;
-        }
-    } else {
-        u8& reg = get_reg();
-        
-        switch (op_type) {
-            case 0: {  // Rotates/shifts
-                u8 sub_op = (opcode >> 3) & 0x07;
-                switch (sub_op) {
-                    case 0: OP_RLC(reg); break;
-                    case 1: OP_RRC(reg); break;
-                    case 2: OP_RL(reg); break;
-                    case 3: OP_RR(reg); break;
-                    case 4: OP_SLA(reg); break;
-                    case 5: OP_SRA(reg); break;
-                    case 6: OP_SWAP(reg); break;
-                    case 7: OP_SRL(reg); break;
-                }
-                break;
-            }
-            case 1: OP_BIT(bit, reg); break;
-            case 2: OP_RES(bit, reg); break;
-            case 3: OP_SET(bit, reg); break;
-        }
-    }
-}
+constinit const std::array<CPU::OpcodeHandler, 256> CPU::s_opcode_table =
+    CPU::MakeOpcodeTable(std::make_index_sequence<256>{});
+
+constinit const std::array<CPU::OpcodeHandler, 256> CPU::s_cb_table =
+    CPU::MakeCBTable(std::make_index_sequence<256>{});
@@ -0,0 +1,114 @@
+#include "trace_ring.hpp"
+#include "../cpu/cpu.hpp"
+#include "../scheduler/scheduler.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = {'D', 'M', 'W', 'T', 'R', 'A', 'C', 'E'};
+constexpr u32 TRACE_VERSION = 1;
+
+struct TraceFileHeader {
+    char magic[8];
+    u32 version;
+    u32 record_size;
+    u64 record_count;
+};
+
+}  // namespace
+
+const char* TraceEventName(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::SCHEDULER_EVENT:   return "event";
+        case TraceEvent::INTERRUPT_REQUEST: return "irq_request";
+        case TraceEvent::INTERRUPT_SERVICE: return "irq_service";
+        case TraceEvent::HALT_WAKE:         return "halt_wake";
+        case TraceEvent::CODE_INVALIDATE:   return "code_invalidate";
+    }
+    return "unknown";
+}
+
+TraceRing::TraceRing(const Scheduler& scheduler, const CPU& cpu, size_t capacity)
+    : m_scheduler(scheduler)
+    , m_cpu(cpu)
+    , m_records(std::bit_ceil(std::max<size_t>(capacity, 1))) {
+}
+
+void TraceRing::Record(TraceEvent event, u8 data) {
+    TraceRecord& record = m_records[m_written & (m_records.size() - 1)];
+    record.cycle = m_scheduler.GetCurrentCycle();
+    record.pc = m_cpu.GetPC();
+    record.event = static_cast<u8>(event);
+    record.data = data;
+    record.reserved = 0;
+    m_written++;
+}
+
+std::vector<TraceRecord> TraceRing::GetRecords() const {
+    const size_t capacity = m_records.size();
+    const size_t count = static_cast<size_t>(std::min<u64>(m_written, capacity));
+
+    std::vector<TraceRecord> records;
+    records.reserve(count);
+    for (u64 i = m_written - count; i < m_written; i++) {
+        records.push_back(m_records[i & (capacity - 1)]);
+    }
+    return records;
+}
+
+bool WriteTraceFile(const std::string& path, const std::vector<TraceRecord>& records) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        spdlog::error("Failed to create trace file: {}", path);
+        return false;
+    }
+
+    TraceFileHeader header;
+    std::copy(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC), header.magic);
+    header.version = TRACE_VERSION;
+    header.record_size = sizeof(TraceRecord);
+    header.record_count = records.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TraceRecord));
+    return file.good();
+}
+
+bool ReadTraceFile(const std::string& path, std::vector<TraceRecord>& records) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        spdlog::error("Failed to open trace file: {}", path);
+        return false;
+    }
+
+    const u64 file_size = static_cast<u64>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    TraceFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !std::equal(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC), header.magic)) {
+        spdlog::error("Not a trace file: {}", path);
+        return false;
+    }
+
+    if (header.version != TRACE_VERSION || header.record_size != sizeof(TraceRecord)) {
+        spdlog::error("Unsupported trace file version {} (record size {})", header.version, header.record_size);
+        return false;
+    }
+
+    // Checked against the file size so a corrupt count can't run away
+    if (header.record_count > (file_size - sizeof(header)) / sizeof(TraceRecord)) {
+        spdlog::error("Truncated trace file: {}", path);
+        return false;
+    }
+
+    records.resize(static_cast<size_t>(header.record_count));
+    if (!file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TraceRecord))) {
+        spdlog::error("Truncated trace file: {}", path);
+        return false;
+    }
+    return true;
+}
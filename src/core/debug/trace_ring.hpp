@@ -0,0 +1,70 @@
+#pragma once
+#include "../types.hpp"
+#include <string>
+#include <vector>
+
+// Binary event trace for deep debugging, compiled in with
+// -DDMWSS_TRACE_RING=ON. Hot paths append fixed-size (cycle, PC, event)
+// records to a ring instead of formatting text; the ring is dumped to a file
+// and decoded offline (dmwss_headless --decode-trace). Without the option
+// TRACE_RECORD compiles to nothing and no component holds a ring.
+#ifndef DMWSS_TRACE_RING
+#define DMWSS_TRACE_RING 0
+#endif
+
+#if DMWSS_TRACE_RING
+#define TRACE_RECORD(ring, event, data) \
+    do { if (UNLIKELY((ring) != nullptr)) (ring)->Record(event, data); } while (0)
+#else
+#define TRACE_RECORD(ring, event, data) ((void)0)
+#endif
+
+class Scheduler;
+class CPU;
+
+enum class TraceEvent : u8 {
+    SCHEDULER_EVENT,     // data: Scheduler::EventType
+    INTERRUPT_REQUEST,   // data: IF bits requested
+    INTERRUPT_SERVICE,   // data: interrupt index (0 = VBlank .. 4 = Joypad)
+    HALT_WAKE,           // data: pending interrupts (IE & IF)
+    CODE_INVALIDATE,     // data: code page whose cached blocks were retired
+};
+
+const char* TraceEventName(TraceEvent event);
+
+// Records made inside an instruction carry the cycle of its first M-cycle
+// (the CPU advances the scheduler clock per instruction) and the live PC
+struct TraceRecord {
+    u64 cycle;
+    u16 pc;
+    u8 event;  // TraceEvent
+    u8 data;
+    u32 reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 16);
+
+class TraceRing {
+public:
+    // Keeps the newest `capacity` records (rounded up to a power of two)
+    TraceRing(const Scheduler& scheduler, const CPU& cpu, size_t capacity);
+
+    void Record(TraceEvent event, u8 data);
+
+    // Oldest first
+    std::vector<TraceRecord> GetRecords() const;
+    size_t GetCapacity() const { return m_records.size(); }
+    u64 GetTotalRecorded() const { return m_written; }
+    void Clear() { m_written = 0; }
+
+private:
+    const Scheduler& m_scheduler;
+    const CPU& m_cpu;
+    std::vector<TraceRecord> m_records;
+    u64 m_written = 0;
+};
+
+// Trace files: "DMWTRACE", u32 version, u32 record size, u64 record count,
+// then the records (host byte order)
+bool WriteTraceFile(const std::string& path, const std::vector<TraceRecord>& records);
+bool ReadTraceFile(const std::string& path, std::vector<TraceRecord>& records);
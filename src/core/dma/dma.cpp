@@ -0,0 +1,65 @@
+#include "dma.hpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+
+DMA::DMA(Memory& memory, Scheduler& scheduler)
+    : m_memory(memory)
+    , m_scheduler(scheduler)
+    , m_source(0xFF) {
+
+    m_scheduler.RegisterEvent(Scheduler::EventType::DMA_TRANSFER,
+        [](void* dma) { static_cast<DMA*>(dma)->OnTransferComplete(); }, this);
+
+    m_memory.MapIOHandler<nullptr, &DMA::WriteDMA>(0xFF46, this, &m_source);
+    Reset();
+}
+
+void DMA::Reset() {
+    m_source = 0xFF;
+    m_scheduler.Deschedule(Scheduler::EventType::DMA_TRANSFER);
+    m_memory.SetOAMLocked(false);
+    m_memory.MarkOAMDirty();
+
+    spdlog::debug("DMA reset");
+}
+
+void DMA::SaveState(State& state) const {
+    state = {};
+    state.source = m_source;
+}
+
+void DMA::LoadState(const State& state) {
+    // Memory restores OAM unlocked; a transfer in flight locks it again
+    m_source = state.source;
+    m_memory.SetOAMLocked(IsActive());
+}
+
+void DMA::WriteDMA(u8 value) {
+    // A new transfer restarts the lockout
+    m_source = value;
+    m_memory.SetOAMLocked(true);
+    m_scheduler.Schedule(Scheduler::EventType::DMA_TRANSFER, TRANSFER_CYCLES);
+}
+
+void DMA::OnTransferComplete() {
+    // Sources above WRAM read the echo of it (0xFE00 -> 0xDE00)
+    const u8 page = m_source >= (Memory::ECHO_RAM_START >> 8) ? m_source - 0x20 : m_source;
+    const u8* source = m_memory.GetReadPage(page);
+    u8* oam = m_memory.GetOAM();
+
+    m_memory.SetOAMLocked(false);
+
+    // The bulk copy bypasses the write path, so flag OAM for the PPU
+    m_memory.MarkOAMDirty();
+
+    if (LIKELY(source != nullptr)) {
+        std::memcpy(oam, source, Memory::OAM_SIZE);
+        return;
+    }
+
+    // Pages off the fastmem tables (ROM past the image, disabled cartridge RAM)
+    const u16 address = static_cast<u16>(page << 8);
+    for (u16 i = 0; i < Memory::OAM_SIZE; i++) {
+        oam[i] = m_memory.Read(address + i);
+    }
+}
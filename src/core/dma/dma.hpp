@@ -0,0 +1,39 @@
+#pragma once
+#include "../types.hpp"
+#include "../memory/memory.hpp"
+#include "../scheduler/scheduler.hpp"
+
+// OAM DMA (0xFF46). Writing a source page starts a 160-byte transfer to OAM
+// that takes 640 cycles on the bus. Instead of moving a byte every four
+// cycles, the transfer locks OAM for its duration and copies all 160 bytes
+// in one go when the DMA_TRANSFER event fires.
+class DMA {
+public:
+    static constexpr u32 TRANSFER_CYCLES = Memory::OAM_SIZE * 4;
+
+    DMA(Memory& memory, Scheduler& scheduler);
+    ~DMA() = default;
+
+    void Reset();
+
+    bool IsActive() const { return m_scheduler.IsScheduled(Scheduler::EventType::DMA_TRANSFER); }
+
+    // Save state (the completion event itself is saved with the scheduler)
+    struct State {
+        u8 source;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
+
+private:
+    Memory& m_memory;
+    Scheduler& m_scheduler;
+
+    u8 m_source;    // Source page (0xFF46), high byte of the address
+
+    void OnTransferComplete();
+
+    // I/O register handlers
+    void WriteDMA(u8 value);
+};
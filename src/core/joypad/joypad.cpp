@@ -0,0 +1,66 @@
+#include "joypad.hpp"
+#include <spdlog/spdlog.h>
+
+Joypad::Joypad(Memory& memory)
+    : m_memory(memory)
+    , m_buttons(0xFF)
+    , m_select(0x00) {
+
+    m_memory.MapIOHandler<&Joypad::ReadP1, &Joypad::WriteP1>(0xFF00, this);
+    Reset();
+}
+
+void Joypad::Reset() {
+    // Nothing pressed; P1 reads 0xCF after the boot ROM
+    m_buttons = 0xFF;
+    m_select = 0x00;
+
+    spdlog::debug("Joypad reset");
+}
+
+void Joypad::SetState(u8 buttons) {
+    const u8 previous_lines = GetLines();
+    m_buttons = buttons;
+    UpdateLines(previous_lines);
+}
+
+void Joypad::SaveState(State& state) const {
+    state = {};
+    state.buttons = m_buttons;
+    state.select = m_select;
+}
+
+void Joypad::LoadState(const State& state) {
+    m_buttons = state.buttons;
+    m_select = state.select & 0x30;
+}
+
+u8 Joypad::GetLines() const {
+    u8 lines = 0x0F;
+    if (!(m_select & 0x10)) {
+        lines &= m_buttons & 0x0F;  // Directions
+    }
+    if (!(m_select & 0x20)) {
+        lines &= m_buttons >> 4;    // Actions
+    }
+    return lines;
+}
+
+void Joypad::UpdateLines(u8 previous_lines) {
+    // Any line pulled low (a press, or selecting a held group) interrupts
+    if (previous_lines & ~GetLines() & 0x0F) {
+        m_memory.RequestInterrupt(0x10);
+    }
+}
+
+u8 Joypad::ReadP1() {
+    // Bits 6-7 are unused and read as 1
+    return 0xC0 | m_select | GetLines();
+}
+
+void Joypad::WriteP1(u8 value) {
+    // Only the select bits are writable
+    const u8 previous_lines = GetLines();
+    m_select = value & 0x30;
+    UpdateLines(previous_lines);
+}
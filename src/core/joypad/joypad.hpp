@@ -0,0 +1,41 @@
+#pragma once
+#include "../types.hpp"
+#include "../memory/memory.hpp"
+
+// Joypad (P1, 0xFF00). The host sets all eight buttons at once; the game
+// selects the direction keys (P14, bit 4 low) and/or the action buttons
+// (P15, bit 5 low) and reads the selected ones in the low nibble, 0 =
+// pressed. A selected line going from high to low requests the joypad
+// interrupt.
+class Joypad {
+public:
+    explicit Joypad(Memory& memory);
+    ~Joypad() = default;
+
+    void Reset();
+
+    // Bit 0-3: Right, Left, Up, Down; bit 4-7: A, B, Select, Start (0 = pressed)
+    void SetState(u8 buttons);
+    u8 GetState() const { return m_buttons; }
+
+    struct State {
+        u8 buttons, select;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
+
+private:
+    Memory& m_memory;
+
+    u8 m_buttons;   // Host button state, layout as SetState
+    u8 m_select;    // P1 bits 4-5 as last written
+
+    // Selected buttons in the P1 low nibble (0 = pressed)
+    u8 GetLines() const;
+    void UpdateLines(u8 previous_lines);
+
+    // I/O register handlers
+    u8 ReadP1();
+    void WriteP1(u8 value);
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <spdlog/spdlog.h>
+
+// Logging for emulator hot paths (events, interrupts, memory accesses).
+// Levels below DMWSS_LOG_LEVEL (an SPDLOG_LEVEL_* value, set by CMake) are
+// compiled out, so call sites below it cost nothing: no level check and no
+// argument evaluation. Cold paths (reset, ROM loading) call spdlog directly.
+#ifndef DMWSS_LOG_LEVEL
+#define DMWSS_LOG_LEVEL SPDLOG_LEVEL_INFO
+#endif
+
+#if DMWSS_LOG_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...) spdlog::trace(__VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if DMWSS_LOG_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if DMWSS_LOG_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOG_WARN(...) spdlog::warn(__VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
@@ -1,117 +1,387 @@
 #pragma once
 #include "../types.hpp"
+#include "rom_image.hpp"
+#include <optional>
+#include <type_traits>
+#include <variant>
 #include <vector>
 #include <memory>
 #include <string>
 
-// Base class for Memory Bank Controllers
-class MBC {
+// Bank registers of every MBC type (each uses the fields it has); the
+// contents of external RAM are saved separately through GetRAMData()
+struct MBCState {
+    u16 rom_bank;
+    u8 ram_bank;
+    u8 ram_enabled;
+    u8 banking_mode;
+    u8 rtc_registers[5];  // Seconds, minutes, hours, days low, days high
+    u8 rtc_latch_data;
+    u8 rtc_latched;
+};
+
+// ROM image and external RAM shared by every mapper type. The mappers below
+// are plain classes with no virtual functions: MBC holds whichever one the
+// cartridge header names, and each access dispatches on that closed set.
+class MBCBase {
 public:
-    virtual ~MBC() = default;
+    const u8* GetROMData() const { return m_rom; }
+    size_t GetROMSize() const { return m_rom_size; }
 
-    // ROM read/write (write is for banking control)
-    virtual u8 Read(u16 address) const = 0;
-    virtual void Write(u16 address, u8 value) = 0;
+    u8* GetRAMData() { return m_ram.data(); }
+    const u8* GetRAMData() const { return m_ram.data(); }
+    size_t GetRAMSize() const { return m_ram.size(); }
 
-    // External RAM read/write
-    virtual u8 ReadRAM(u16 address) const = 0;
-    virtual void WriteRAM(u16 address, u8 value) = 0;
+    void SaveState(MBCState& state) const { state = {}; state.ram_enabled = m_ram_enabled; }
+    void LoadState(const MBCState& state) { m_ram_enabled = state.ram_enabled != 0; }
 
-    // Save/Load external RAM
-    virtual bool SaveRAM(const std::string& path) = 0;
-    virtual bool LoadRAM(const std::string& path) = 0;
+protected:
+    MBCBase(std::shared_ptr<const ROMImage> rom, size_t ram_size)
+        : m_image(std::move(rom))
+        , m_rom(m_image->GetData())
+        , m_rom_size(m_image->GetSize())
+        , m_ram(ram_size, 0) {}
 
-    // Factory method to create appropriate MBC based on cartridge type
-    static std::unique_ptr<MBC> Create(u8 cartridge_type, const u8* rom_data, size_t rom_size);
+    // Switchable-bank ROM read shared by the banked mappers
+    u8 ReadROM(u32 bank_offset, u16 address) const {
+        if (address <= 0x3FFF) {
+            // ROM Bank 0
+            return m_rom[address];
+        }
+        // Switchable bank
+        const u32 offset = bank_offset + (address - 0x4000);
+        return offset < m_rom_size ? m_rom[offset] : 0xFF;
+    }
 
-protected:
-    std::vector<u8> m_rom;
+    bool SaveRAMFile(const std::string& path) const;
+    bool LoadRAMFile(const std::string& path);
+
+    std::shared_ptr<const ROMImage> m_image;
+    const u8* m_rom;
+    size_t m_rom_size;
     std::vector<u8> m_ram;
     bool m_ram_enabled = false;
 };
 
+// The hot accessors (Read, Write, ReadRAM, WriteRAM and the bank mapping)
+// are defined in the class bodies so they inline into MBC's dispatch.
+// GetRAMBankPointer() returns nullptr while RAM is disabled or the bank is
+// not plain RAM (e.g. MBC3 RTC registers), leaving it on the slow path.
+
 // MBC0 - No MBC (32KB ROM only, no banking)
-class MBC0 : public MBC {
+class MBC0 : public MBCBase {
 public:
-    MBC0(const u8* rom_data, size_t rom_size);
-
-    u8 Read(u16 address) const override;
-    void Write(u16 address, u8 value) override;
-    u8 ReadRAM(u16 address) const override;
-    void WriteRAM(u16 address, u8 value) override;
-    bool SaveRAM(const std::string& path) override;
-    bool LoadRAM(const std::string& path) override;
+    explicit MBC0(std::shared_ptr<const ROMImage> rom);
+
+    u8 Read(u16 address) const {
+        return address < m_rom_size ? m_rom[address] : 0xFF;
+    }
+
+    // ROM writes are ignored, and there is no RAM
+    void Write(u16, u8) {}
+    u8 ReadRAM(u16) const { return 0xFF; }
+    void WriteRAM(u16, u8) {}
+
+    u32 GetROMBankOffset() const { return 0x4000; }  // Fixed second half of the 32KB ROM
+    u8* GetRAMBankPointer() { return nullptr; }
+
+    bool SaveRAM(const std::string&) const { return true; }  // No RAM to save
+    bool LoadRAM(const std::string&) { return true; }
 };
 
 // MBC1 - Up to 2MB ROM, 32KB RAM
-class MBC1 : public MBC {
+class MBC1 : public MBCBase {
 public:
-    MBC1(const u8* rom_data, size_t rom_size);
+    explicit MBC1(std::shared_ptr<const ROMImage> rom);
 
-    u8 Read(u16 address) const override;
-    void Write(u16 address, u8 value) override;
-    u8 ReadRAM(u16 address) const override;
-    void WriteRAM(u16 address, u8 value) override;
-    bool SaveRAM(const std::string& path) override;
-    bool LoadRAM(const std::string& path) override;
+    u8 Read(u16 address) const { return ReadROM(GetROMBankOffset(), address); }
+
+    void Write(u16 address, u8 value) {
+        if (address <= 0x1FFF) {
+            // RAM Enable
+            m_ram_enabled = (value & 0x0F) == 0x0A;
+        } else if (address <= 0x3FFF) {
+            // ROM Bank Number (lower 5 bits)
+            m_rom_bank = value & 0x1F;
+            if (m_rom_bank == 0) m_rom_bank = 1;
+        } else if (address <= 0x5FFF) {
+            // RAM Bank Number or upper bits of ROM Bank Number
+            m_ram_bank = value & 0x03;
+        } else if (address <= 0x7FFF) {
+            // Banking Mode Select
+            m_banking_mode = (value & 0x01) != 0;
+        }
+    }
+
+    u8 ReadRAM(u16 address) const {
+        if (!m_ram_enabled) return 0xFF;
+        const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+        return offset < m_ram.size() ? m_ram[offset] : 0xFF;
+    }
+
+    void WriteRAM(u16 address, u8 value) {
+        if (!m_ram_enabled) return;
+        const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+        if (offset < m_ram.size()) {
+            m_ram[offset] = value;
+        }
+    }
+
+    u32 GetROMBankOffset() const {
+        // Only the lower 5 bits select the bank in either banking mode;
+        // bank 0 redirects to bank 1
+        u8 bank = m_rom_bank & 0x1F;
+        if (bank == 0) bank = 1;
+        return bank * 0x4000;
+    }
+
+    u8* GetRAMBankPointer() {
+        if (!m_ram_enabled) return nullptr;
+        return m_ram.data() + GetRAMBankOffset();
+    }
+
+    bool SaveRAM(const std::string& path) const { return SaveRAMFile(path); }
+    bool LoadRAM(const std::string& path) { return LoadRAMFile(path); }
+    void SaveState(MBCState& state) const;
+    void LoadState(const MBCState& state);
 
 private:
     u8 m_rom_bank = 1;      // ROM bank number (1-127)
     u8 m_ram_bank = 0;      // RAM bank number (0-3)
     bool m_banking_mode = false;  // false = ROM banking, true = RAM banking
 
-    u32 GetROMBankOffset() const;
-    u32 GetRAMBankOffset() const;
+    // RAM banking mode selects the RAM bank; ROM banking mode always uses bank 0
+    u32 GetRAMBankOffset() const { return m_banking_mode ? (m_ram_bank & 0x03) * 0x2000 : 0; }
 };
 
 // MBC3 - Up to 2MB ROM, 32KB RAM, RTC (Real-Time Clock)
-class MBC3 : public MBC {
+class MBC3 : public MBCBase {
 public:
-    MBC3(const u8* rom_data, size_t rom_size, bool has_rtc);
+    MBC3(std::shared_ptr<const ROMImage> rom, bool has_rtc);
+
+    u8 Read(u16 address) const { return ReadROM(GetROMBankOffset(), address); }
+
+    void Write(u16 address, u8 value) {
+        if (address <= 0x1FFF) {
+            // RAM and Timer Enable
+            m_ram_enabled = (value & 0x0F) == 0x0A;
+        } else if (address <= 0x3FFF) {
+            // ROM Bank Number (7 bits)
+            m_rom_bank = value & 0x7F;
+            if (m_rom_bank == 0) m_rom_bank = 1;
+        } else if (address <= 0x5FFF) {
+            // RAM Bank Number or RTC Register Select
+            m_ram_bank = value;
+        } else if (address <= 0x7FFF) {
+            // Latch Clock Data
+            if (m_rtc_latch_data == 0x00 && value == 0x01) {
+                m_rtc_latched = true;
+                // TODO: Latch current RTC values
+            }
+            m_rtc_latch_data = value;
+        }
+    }
+
+    u8 ReadRAM(u16 address) const {
+        if (!m_ram_enabled) return 0xFF;
+
+        if (m_ram_bank <= 0x03) {
+            // RAM access
+            const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+            return offset < m_ram.size() ? m_ram[offset] : 0xFF;
+        }
+        if (m_has_rtc && m_ram_bank >= 0x08 && m_ram_bank <= 0x0C) {
+            // RTC register access
+            return m_rtc_registers[m_ram_bank - 0x08];
+        }
+        return 0xFF;
+    }
+
+    void WriteRAM(u16 address, u8 value) {
+        if (!m_ram_enabled) return;
+
+        if (m_ram_bank <= 0x03) {
+            // RAM access
+            const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+            if (offset < m_ram.size()) {
+                m_ram[offset] = value;
+            }
+        } else if (m_has_rtc && m_ram_bank >= 0x08 && m_ram_bank <= 0x0C) {
+            // RTC register write
+            m_rtc_registers[m_ram_bank - 0x08] = value;
+        }
+    }
+
+    u32 GetROMBankOffset() const {
+        u8 bank = m_rom_bank & 0x7F;
+        if (bank == 0) bank = 1;
+        return bank * 0x4000;
+    }
 
-    u8 Read(u16 address) const override;
-    void Write(u16 address, u8 value) override;
-    u8 ReadRAM(u16 address) const override;
-    void WriteRAM(u16 address, u8 value) override;
-    bool SaveRAM(const std::string& path) override;
-    bool LoadRAM(const std::string& path) override;
+    u8* GetRAMBankPointer() {
+        // RTC registers (banks 0x08-0x0C) stay on the slow path
+        if (!m_ram_enabled || m_ram_bank > 0x03) return nullptr;
+        return m_ram.data() + GetRAMBankOffset();
+    }
+
+    // TODO: Save/load RTC data alongside the RAM
+    bool SaveRAM(const std::string& path) const { return SaveRAMFile(path); }
+    bool LoadRAM(const std::string& path) { return LoadRAMFile(path); }
+    void SaveState(MBCState& state) const;
+    void LoadState(const MBCState& state);
 
 private:
     u8 m_rom_bank = 1;      // ROM bank number (1-127)
     u8 m_ram_bank = 0;      // RAM bank or RTC register select (0-3 = RAM, 8-12 = RTC)
     bool m_has_rtc;
 
-    // RTC registers
-    u8 m_rtc_seconds = 0;
-    u8 m_rtc_minutes = 0;
-    u8 m_rtc_hours = 0;
-    u8 m_rtc_days_low = 0;
-    u8 m_rtc_days_high = 0;
+    // RTC registers: seconds, minutes, hours, days low, days high
+    std::array<u8, 5> m_rtc_registers{};
 
     // RTC latch
     u8 m_rtc_latch_data = 0;
     bool m_rtc_latched = false;
 
-    u32 GetROMBankOffset() const;
-    u32 GetRAMBankOffset() const;
+    u32 GetRAMBankOffset() const { return (m_ram_bank & 0x03) * 0x2000; }
 };
 
 // MBC5 - Up to 8MB ROM, 128KB RAM
-class MBC5 : public MBC {
+class MBC5 : public MBCBase {
 public:
-    MBC5(const u8* rom_data, size_t rom_size);
+    explicit MBC5(std::shared_ptr<const ROMImage> rom);
+
+    u8 Read(u16 address) const { return ReadROM(GetROMBankOffset(), address); }
+
+    void Write(u16 address, u8 value) {
+        if (address <= 0x1FFF) {
+            // RAM Enable
+            m_ram_enabled = (value & 0x0F) == 0x0A;
+        } else if (address <= 0x2FFF) {
+            // ROM Bank Number (lower 8 bits)
+            m_rom_bank = (m_rom_bank & 0x100) | value;
+        } else if (address <= 0x3FFF) {
+            // ROM Bank Number (9th bit)
+            m_rom_bank = (m_rom_bank & 0x0FF) | ((value & 0x01) << 8);
+        } else if (address <= 0x5FFF) {
+            // RAM Bank Number (4 bits)
+            m_ram_bank = value & 0x0F;
+        }
+    }
+
+    u8 ReadRAM(u16 address) const {
+        if (!m_ram_enabled) return 0xFF;
+        const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+        return offset < m_ram.size() ? m_ram[offset] : 0xFF;
+    }
+
+    void WriteRAM(u16 address, u8 value) {
+        if (!m_ram_enabled) return;
+        const u32 offset = GetRAMBankOffset() + (address - 0xA000);
+        if (offset < m_ram.size()) {
+            m_ram[offset] = value;
+        }
+    }
+
+    u32 GetROMBankOffset() const { return m_rom_bank * 0x4000; }
+
+    u8* GetRAMBankPointer() {
+        if (!m_ram_enabled) return nullptr;
+        return m_ram.data() + GetRAMBankOffset();
+    }
 
-    u8 Read(u16 address) const override;
-    void Write(u16 address, u8 value) override;
-    u8 ReadRAM(u16 address) const override;
-    void WriteRAM(u16 address, u8 value) override;
-    bool SaveRAM(const std::string& path) override;
-    bool LoadRAM(const std::string& path) override;
+    bool SaveRAM(const std::string& path) const { return SaveRAMFile(path); }
+    bool LoadRAM(const std::string& path) { return LoadRAMFile(path); }
+    void SaveState(MBCState& state) const;
+    void LoadState(const MBCState& state);
 
 private:
     u16 m_rom_bank = 1;     // ROM bank number (0-511)
     u8 m_ram_bank = 0;      // RAM bank number (0-15)
 
-    u32 GetROMBankOffset() const;
-    u32 GetRAMBankOffset() const;
+    u32 GetRAMBankOffset() const { return (m_ram_bank & 0x0F) * 0x2000; }
+};
+
+// Dispatch on the mapper held in an MBC::Mapper. A plain switch keeps every
+// case inlined; std::visit may go through a table of function pointers.
+template <typename Mapper, typename F>
+FORCE_INLINE decltype(auto) VisitMapper(Mapper& mapper, F&& f) {
+    static_assert(std::variant_size_v<std::remove_const_t<Mapper>> == 4);
+    switch (mapper.index()) {
+        case 0:  return f(*std::get_if<0>(&mapper));
+        case 1:  return f(*std::get_if<1>(&mapper));
+        case 2:  return f(*std::get_if<2>(&mapper));
+        default: return f(*std::get_if<3>(&mapper));
+    }
+}
+
+// Memory Bank Controller of the loaded cartridge. The mapper set is closed,
+// so it is held by value in a variant chosen once by Create(): every call
+// below is a jump on the mapper type into an inlined accessor instead of a
+// virtual call, and bank-register writes compile down to the mapper's own
+// few stores.
+class MBC {
+public:
+    using Mapper = std::variant<MBC0, MBC1, MBC3, MBC5>;
+    using State = MBCState;
+
+    // ROM read/write (write is for banking control)
+    u8 Read(u16 address) const {
+        return VisitMapper(m_mapper, [&](const auto& mbc) { return mbc.Read(address); });
+    }
+    void Write(u16 address, u8 value) {
+        VisitMapper(m_mapper, [&](auto& mbc) { mbc.Write(address, value); });
+    }
+
+    // External RAM read/write
+    u8 ReadRAM(u16 address) const {
+        return VisitMapper(m_mapper, [&](const auto& mbc) { return mbc.ReadRAM(address); });
+    }
+    void WriteRAM(u16 address, u8 value) {
+        VisitMapper(m_mapper, [&](auto& mbc) { mbc.WriteRAM(address, value); });
+    }
+
+    // Current bank mapping, published into the Memory fastmem page tables
+    u32 GetROMBankOffset() const {
+        return VisitMapper(m_mapper, [](const auto& mbc) { return mbc.GetROMBankOffset(); });
+    }
+    u8* GetRAMBankPointer() {
+        return VisitMapper(m_mapper, [](auto& mbc) { return mbc.GetRAMBankPointer(); });
+    }
+
+    u16 GetROMBank() const { return static_cast<u16>(GetROMBankOffset() / 0x4000); }
+    const u8* GetROMData() const { return Base().GetROMData(); }
+    size_t GetROMSize() const { return Base().GetROMSize(); }
+
+    // Save/Load external RAM
+    bool SaveRAM(const std::string& path) const {
+        return VisitMapper(m_mapper, [&](const auto& mbc) { return mbc.SaveRAM(path); });
+    }
+    bool LoadRAM(const std::string& path) {
+        return VisitMapper(m_mapper, [&](auto& mbc) { return mbc.LoadRAM(path); });
+    }
+
+    void SaveState(State& state) const {
+        VisitMapper(m_mapper, [&](const auto& mbc) { mbc.SaveState(state); });
+    }
+    void LoadState(const State& state) {
+        VisitMapper(m_mapper, [&](auto& mbc) { mbc.LoadState(state); });
+    }
+
+    u8* GetRAMData() { return Base().GetRAMData(); }
+    const u8* GetRAMData() const { return Base().GetRAMData(); }
+    size_t GetRAMSize() const { return Base().GetRAMSize(); }
+
+    // Pick the mapper from the cartridge header (nullopt if unsupported).
+    // The MBC keeps a reference to the shared image rather than a copy.
+    static std::optional<MBC> Create(std::shared_ptr<const ROMImage> rom);
+
+private:
+    explicit MBC(Mapper mapper) : m_mapper(std::move(mapper)) {}
+
+    Mapper m_mapper;
+
+    MBCBase& Base() { return VisitMapper(m_mapper, [](MBCBase& mbc) -> MBCBase& { return mbc; }); }
+    const MBCBase& Base() const {
+        return VisitMapper(m_mapper, [](const MBCBase& mbc) -> const MBCBase& { return mbc; });
+    }
 };
@@ -1,11 +1,20 @@
 #include "memory.hpp"
 #include "mbc.hpp"
-#include <spdlog/spdlog.h>
+#include "../log.hpp"
+#include <algorithm>
 #include <cstring>
 
 Memory::Memory()
-    : m_ie_register(0)
-    , m_mbc(nullptr) {
+    : m_interrupt_state_changed(true)
+    , m_oam_dirty(true)
+    , m_oam_locked(false)
+    , m_read_page_table{}
+    , m_code_generation{} {
+    // Every I/O register starts out as a plain byte in the I/O buffer
+    for (u16 offset = 0; offset < IO_SIZE; offset++) {
+        MapIORegister(IO_START + offset);
+    }
+
     Reset();
 }
 
@@ -18,7 +27,9 @@ void Memory::Reset() {
     m_oam.fill(0);
     m_hram.fill(0);
     m_io.fill(0);
-    m_ie_register = 0;
+    m_interrupt_state_changed = true;
+    MarkAllTilesDirty();
+    MarkOAMDirty();
 
     // Initialize page tables
     InitializePageTables();
@@ -26,16 +37,60 @@ void Memory::Reset() {
     spdlog::debug("Memory system reset");
 }
 
+void Memory::SaveState(State& state) const {
+    state.wram = m_wram;
+    state.vram = m_vram;
+    state.oam = m_oam;
+    state.hram = m_hram;
+    state.io = m_io;
+
+    state.mbc = {};
+    if (m_mbc) {
+        m_mbc->SaveState(state.mbc);
+    }
+}
+
+void Memory::LoadState(const State& state) {
+    m_wram = state.wram;
+    m_vram = state.vram;
+    m_oam = state.oam;
+    m_hram = state.hram;
+    m_io = state.io;
+
+    if (m_mbc) {
+        m_mbc->LoadState(state.mbc);
+    }
+
+    // Remap the restored banks and retire all cached RAM code
+    InitializePageTables();
+    MarkAllTilesDirty();
+    MarkOAMDirty();
+    m_interrupt_state_changed = true;
+}
+
 void Memory::InitializePageTables() {
-    // Initialize all pages to nullptr (slow path)
-    m_read_page_table.fill(nullptr);
+    // Initialize all RAM pages to nullptr (slow path). The ROM mappings are
+    // kept: MapCartridgeBanks below only touches them, and retires the code
+    // cached from them, when a different bank or ROM is mapped. That keeps
+    // the CPU block cache warm across save state loads.
+    constexpr u16 ROM_PAGES = (ROM_BANK_N_END + 1) / PAGE_SIZE;
+    std::fill(m_read_page_table.begin() + ROM_PAGES, m_read_page_table.end(), nullptr);
     m_write_page_table.fill(nullptr);
 
+    // Drop all code protection; bumping the generations retires cached blocks
+    m_code_page_table.fill(nullptr);
+    for (u16 page = ROM_PAGES; page < PAGE_COUNT; page++) {
+        m_code_generation[page]++;
+    }
+
     // Map VRAM (0x8000-0x9FFF) - 32 pages (8KB / 256 bytes)
+    // Tile data writes (0x8000-0x97FF) go through the slow path for dirty tracking
     for (size_t i = 0; i < 32; i++) {
         u16 page_index = (VRAM_START + i * PAGE_SIZE) / PAGE_SIZE;
         m_read_page_table[page_index] = m_vram.data() + (i * PAGE_SIZE);
-        m_write_page_table[page_index] = m_vram.data() + (i * PAGE_SIZE);
+        if (page_index > (TILE_DATA_END >> 8)) {
+            m_write_page_table[page_index] = m_vram.data() + (i * PAGE_SIZE);
+        }
     }
 
     // Map WRAM (0xC000-0xDFFF) - 32 pages (8KB / 256 bytes)
@@ -56,29 +111,109 @@ void Memory::InitializePageTables() {
         }
     }
 
-    // HRAM (0xFF80-0xFFFE) is in the I/O page, handled by slow path
-    // OAM, I/O, and ROM are also handled by slow path
+    // Map cartridge ROM and external RAM banks
+    MapCartridgeBanks();
+
+    // OAM (0xFE00-0xFE9F) and HRAM + IE (0xFF80-0xFFFF) share pages with
+    // the unusable region and I/O, so they are mapped per 32-byte sub-page.
+    // The unusable region and I/O stay on the slow path.
+    m_read_subpage_table.fill(nullptr);
+    m_write_subpage_table.fill(nullptr);
+
+    SetOAMLocked(false);
+
+    for (size_t i = 0; i < m_hram.size() / SUBPAGE_SIZE; i++) {
+        const size_t index = (HRAM_START - OAM_START) / SUBPAGE_SIZE + i;
+        m_read_subpage_table[index] = m_hram.data() + i * SUBPAGE_SIZE;
+        m_write_subpage_table[index] = m_hram.data() + i * SUBPAGE_SIZE;
+    }
 
     spdlog::trace("Page tables initialized");
 }
 
+void Memory::SetOAMLocked(bool locked) {
+    // A locked OAM drops to the slow path like the unusable region. Writes
+    // always take the slow path, which tracks OAM changes for the PPU.
+    m_oam_locked = locked;
+    for (size_t i = 0; i < OAM_SIZE / SUBPAGE_SIZE; i++) {
+        m_read_subpage_table[i] = locked ? nullptr : m_oam.data() + i * SUBPAGE_SIZE;
+    }
+}
+
+void Memory::MapCartridgeBanks() {
+    constexpr u16 ROM_BANK_PAGES = (ROM_BANK_N_START - ROM_BANK_0_START) / PAGE_SIZE;
+    constexpr u16 RAM_BANK_PAGES = (EXTERNAL_RAM_END - EXTERNAL_RAM_START + 1) / PAGE_SIZE;
+    constexpr u16 ROM_BANK_0_PAGE = ROM_BANK_0_START / PAGE_SIZE;
+    constexpr u16 ROM_BANK_N_PAGE = ROM_BANK_N_START / PAGE_SIZE;
+    constexpr u16 RAM_PAGE = EXTERNAL_RAM_START / PAGE_SIZE;
+
+    const u8* rom = m_mbc ? m_mbc->GetROMData() : nullptr;
+    const size_t rom_size = m_mbc ? m_mbc->GetROMSize() : 0;
+    const u32 bank_offset = m_mbc ? m_mbc->GetROMBankOffset() : 0;
+    u8* ram = m_mbc ? m_mbc->GetRAMBankPointer() : nullptr;
+
+    // ROM is read-only here: writes always reach the MBC through the slow path.
+    // Pages past the end of the ROM image stay unmapped and read as 0xFF.
+    auto rom_page = [&](u32 offset) -> const u8* {
+        return (rom && offset + PAGE_SIZE <= rom_size) ? rom + offset : nullptr;
+    };
+
+    if (m_read_page_table[ROM_BANK_0_PAGE] != rom_page(0)) {
+        for (u16 i = 0; i < ROM_BANK_PAGES; i++) {
+            m_read_page_table[ROM_BANK_0_PAGE + i] = rom_page(i * PAGE_SIZE);
+            m_code_generation[ROM_BANK_0_PAGE + i]++;
+        }
+    }
+
+    if (m_read_page_table[ROM_BANK_N_PAGE] != rom_page(bank_offset)) {
+        for (u16 i = 0; i < ROM_BANK_PAGES; i++) {
+            m_read_page_table[ROM_BANK_N_PAGE + i] = rom_page(bank_offset + i * PAGE_SIZE);
+        }
+        m_code_generation[CodePageIndex(ROM_BANK_N_PAGE)]++;
+    }
+
+    // External RAM is mapped both ways while enabled. Code cached from the
+    // previous bank is retired along with its page protection.
+    if (m_read_page_table[RAM_PAGE] != ram) {
+        for (u16 i = 0; i < RAM_BANK_PAGES; i++) {
+            const u16 page = RAM_PAGE + i;
+            m_read_page_table[page] = ram ? ram + i * PAGE_SIZE : nullptr;
+            m_write_page_table[page] = ram ? ram + i * PAGE_SIZE : nullptr;
+            m_code_page_table[page] = nullptr;
+            m_code_generation[page]++;
+        }
+    }
+}
+
 u8 Memory::Read(u16 address) const {
     const u8 page = address / PAGE_SIZE;
     const u8 offset = address % PAGE_SIZE;
-    u8* page_ptr = m_read_page_table[page];
+    const u8* page_ptr = m_read_page_table[page];
 
     if (LIKELY(page_ptr != nullptr)) {
         // Fast path: direct memory access
+        PERF_COUNT(m_perf.fast_reads[perf::RegionIndex(address)]);
         return page_ptr[offset];
     }
 
+    if (address >= OAM_START) {
+        // OAM and HRAM: direct sub-page access
+        const u8* subpage_ptr = m_read_subpage_table[(address - OAM_START) / SUBPAGE_SIZE];
+        if (LIKELY(subpage_ptr != nullptr)) {
+            PERF_COUNT(m_perf.fast_reads[perf::RegionIndex(address)]);
+            return subpage_ptr[address % SUBPAGE_SIZE];
+        }
+    }
+
+    PERF_COUNT(m_perf.slow_reads[perf::RegionIndex(address)]);
+
     // Slow path: handle special regions
     if (address >= ROM_BANK_0_START && address <= ROM_BANK_N_END) {
         // ROM access - delegate to MBC
         if (m_mbc) {
             return m_mbc->Read(address);
         }
-        spdlog::warn("Read from ROM address 0x{:04X} but no ROM loaded", address);
+        LOG_WARN("Read from ROM address 0x{:04X} but no ROM loaded", address);
         return 0xFF;
     }
     else if (address >= EXTERNAL_RAM_START && address <= EXTERNAL_RAM_END) {
@@ -88,28 +223,17 @@ u8 Memory::Read(u16 address) const {
         }
         return 0xFF;
     }
-    else if (address >= OAM_START && address <= OAM_END) {
-        // OAM
-        return m_oam[address - OAM_START];
-    }
-    else if (address >= UNUSABLE_START && address <= UNUSABLE_END) {
-        // Unusable memory region
+    else if (address >= OAM_START && address <= UNUSABLE_END) {
+        // Unusable memory region, or OAM during DMA
         return 0xFF;
     }
     else if (address >= IO_START && address <= IO_END) {
         // I/O registers
         return ReadIO(address);
     }
-    else if (address >= HRAM_START && address <= HRAM_END) {
-        // High RAM
-        return m_hram[address - HRAM_START];
-    }
-    else if (address == IE_REGISTER) {
-        // Interrupt Enable register
-        return m_ie_register;
-    }
 
-    spdlog::warn("Read from unmapped address 0x{:04X}", address);
+    // Open bus; valid for games to do, so only worth a note when debugging
+    LOG_DEBUG("Read from unmapped address 0x{:04X}", address);
     return 0xFF;
 }
 
@@ -120,16 +244,53 @@ void Memory::Write(u16 address, u8 value) {
 
     if (LIKELY(page_ptr != nullptr)) {
         // Fast path: direct memory access
+        PERF_COUNT(m_perf.fast_writes[perf::RegionIndex(address)]);
         page_ptr[offset] = value;
         return;
     }
 
+    if (address >= OAM_START) {
+        // HRAM (and IE): direct sub-page access
+        u8* subpage_ptr = m_write_subpage_table[(address - OAM_START) / SUBPAGE_SIZE];
+        if (LIKELY(subpage_ptr != nullptr)) {
+            PERF_COUNT(m_perf.fast_writes[perf::RegionIndex(address)]);
+            subpage_ptr[address % SUBPAGE_SIZE] = value;
+            if (UNLIKELY(address == IE_REGISTER)) {
+                m_interrupt_state_changed = true;
+            }
+            return;
+        }
+    }
+
+    PERF_COUNT(m_perf.slow_writes[perf::RegionIndex(address)]);
+
     // Slow path: handle special regions
-    if (address >= ROM_BANK_0_START && address <= ROM_BANK_N_END) {
+    if (UNLIKELY(m_code_page_table[page] != nullptr)) {
+        // Store into a page holding cached code
+        u8* code_page = m_code_page_table[page];
+        InvalidateCodePage(page);
+        code_page[offset] = value;
+        return;
+    }
+    else if (address >= VRAM_START && address <= TILE_DATA_END) {
+        // VRAM tile data - mark the tile for the PPU's decoded copy
+        const u16 vram_offset = address - VRAM_START;
+        const u16 tile = vram_offset / TILE_SIZE;
+        m_vram[vram_offset] = value;
+        m_dirty_tiles[tile / 64] |= 1ull << (tile % 64);
+
+        // These pages can't be write-protected, so retire any code cached from them
+        m_code_generation[page]++;
+        return;
+    }
+    else if (address >= ROM_BANK_0_START && address <= ROM_BANK_N_END) {
         // ROM write - delegate to MBC (for banking control)
         if (m_mbc) {
             m_mbc->Write(address, value);
+            MapCartridgeBanks();
         }
+        // Blocks decoded from the switchable bank may no longer be mapped
+        m_code_generation[CodePageIndex(ROM_BANK_N_START >> 8)]++;
         return;
     }
     else if (address >= EXTERNAL_RAM_START && address <= EXTERNAL_RAM_END) {
@@ -139,13 +300,14 @@ void Memory::Write(u16 address, u8 value) {
         }
         return;
     }
-    else if (address >= OAM_START && address <= OAM_END) {
-        // OAM
+    else if (address >= OAM_START && address <= OAM_END && !m_oam_locked) {
+        // OAM - flag the change for the PPU's sprite index
         m_oam[address - OAM_START] = value;
+        m_oam_dirty = true;
         return;
     }
-    else if (address >= UNUSABLE_START && address <= UNUSABLE_END) {
-        // Unusable memory region - ignore writes
+    else if (address >= OAM_START && address <= UNUSABLE_END) {
+        // Unusable memory region, or OAM during DMA - ignore writes
         return;
     }
     else if (address >= IO_START && address <= IO_END) {
@@ -153,21 +315,29 @@ void Memory::Write(u16 address, u8 value) {
         WriteIO(address, value);
         return;
     }
-    else if (address >= HRAM_START && address <= HRAM_END) {
-        // High RAM
-        m_hram[address - HRAM_START] = value;
-        return;
-    }
-    else if (address == IE_REGISTER) {
-        // Interrupt Enable register
-        m_ie_register = value;
-        return;
-    }
 
-    spdlog::warn("Write to unmapped address 0x{:04X} = 0x{:02X}", address, value);
+    LOG_DEBUG("Write to unmapped address 0x{:04X} = 0x{:02X}", address, value);
 }
 
 u16 Memory::Read16(u16 address) const {
+    const u8 offset = address % PAGE_SIZE;
+    const u8* page_ptr = m_read_page_table[address / PAGE_SIZE];
+
+    if (LIKELY(page_ptr != nullptr && offset != PAGE_SIZE - 1)) {
+        // Fast path: both bytes in one mapped page
+        PERF_COUNT(m_perf.fast_reads[perf::RegionIndex(address)]);
+        return LoadLE16(page_ptr + offset);
+    }
+
+    if (address >= OAM_START && address % SUBPAGE_SIZE != SUBPAGE_SIZE - 1) {
+        // HRAM stack and OAM: both bytes in one sub-page
+        const u8* subpage_ptr = m_read_subpage_table[(address - OAM_START) / SUBPAGE_SIZE];
+        if (LIKELY(subpage_ptr != nullptr)) {
+            PERF_COUNT(m_perf.fast_reads[perf::RegionIndex(address)]);
+            return LoadLE16(subpage_ptr + address % SUBPAGE_SIZE);
+        }
+    }
+
     // Little-endian: low byte first, then high byte
     u8 low = Read(address);
     u8 high = Read(address + 1);
@@ -175,72 +345,157 @@ u16 Memory::Read16(u16 address) const {
 }
 
 void Memory::Write16(u16 address, u16 value) {
+    const u8 offset = address % PAGE_SIZE;
+    u8* page_ptr = m_write_page_table[address / PAGE_SIZE];
+
+    if (LIKELY(page_ptr != nullptr && offset != PAGE_SIZE - 1)) {
+        // Fast path: both bytes in one mapped page
+        PERF_COUNT(m_perf.fast_writes[perf::RegionIndex(address)]);
+        StoreLE16(page_ptr + offset, value);
+        return;
+    }
+
+    if (address >= OAM_START && address % SUBPAGE_SIZE != SUBPAGE_SIZE - 1 &&
+        address + 1 != IE_REGISTER) {
+        // HRAM stack: both bytes in one sub-page (IE goes the long way)
+        u8* subpage_ptr = m_write_subpage_table[(address - OAM_START) / SUBPAGE_SIZE];
+        if (LIKELY(subpage_ptr != nullptr)) {
+            PERF_COUNT(m_perf.fast_writes[perf::RegionIndex(address)]);
+            StoreLE16(subpage_ptr + address % SUBPAGE_SIZE, value);
+            return;
+        }
+    }
+
     // Little-endian: low byte first, then high byte
     Write(address, static_cast<u8>(value & 0xFF));
     Write(address + 1, static_cast<u8>((value >> 8) & 0xFF));
 }
 
-bool Memory::LoadROM(const u8* data, size_t size) {
-    if (!data || size < 0x150) {
-        spdlog::error("Invalid ROM data or size too small");
+bool Memory::LoadROM(std::shared_ptr<const ROMImage> rom) {
+    if (!rom) {
+        spdlog::error("Invalid ROM image");
         return false;
     }
 
-    // Read cartridge header to determine MBC type
-    u8 cartridge_type = data[0x0147];
+    // Create appropriate MBC from the cartridge header
+    const u8 cartridge_type = rom->GetHeader().cartridge_type;
+    const size_t size = rom->GetSize();
 
-    // Create appropriate MBC
-    m_mbc = MBC::Create(cartridge_type, data, size);
+    m_mbc = MBC::Create(std::move(rom));
     if (!m_mbc) {
         spdlog::error("Failed to create MBC for cartridge type 0x{:02X}", cartridge_type);
         return false;
     }
 
+    // Unmap the old ROM first: a new image may reuse the old one's address
+    std::fill(m_read_page_table.begin(), m_read_page_table.begin() + (ROM_BANK_N_END + 1) / PAGE_SIZE, nullptr);
+    MapCartridgeBanks();
+
     spdlog::info("ROM loaded successfully, cartridge type: 0x{:02X}, size: {} bytes",
                  cartridge_type, size);
     return true;
 }
 
+bool Memory::LoadROM(const u8* data, size_t size) {
+    if (!data) {
+        spdlog::error("Invalid ROM data");
+        return false;
+    }
+
+    return LoadROM(ROMImage::FromData(std::vector<u8>(data, data + size)));
+}
+
 u8 Memory::ReadIO(u16 address) const {
-    // Default I/O register behavior: read from buffer
-    u16 offset = address - IO_START;
+    const IORegister& io = m_io_registers[address - IO_START];
+    PERF_COUNT(m_perf.io_reads[address - IO_START]);
 
-    // Check if we have a custom handler
-    if (m_io_read_handlers[offset]) {
-        return m_io_read_handlers[offset](address);
+    if (io.read) {
+        return io.read(io.context, address);
     }
 
-    return m_io[offset];
+    return *io.storage | io.read_mask;
 }
 
 void Memory::WriteIO(u16 address, u8 value) {
-    // Default I/O register behavior: write to buffer
-    u16 offset = address - IO_START;
+    const u16 offset = address - IO_START;
+    const IORegister& io = m_io_registers[offset];
+    PERF_COUNT(m_perf.io_writes[offset]);
 
-    // Check if we have a custom handler
-    if (m_io_write_handlers[offset]) {
-        m_io_write_handlers[offset](address, value);
+    if (io.write) {
+        io.write(io.context, address, value);
     } else {
-        m_io[offset] = value;
+        *io.storage = (*io.storage & ~io.write_mask) | (value & io.write_mask);
     }
+
+    // IF (0xFF0F)
+    if (offset == 0x0F) {
+        m_interrupt_state_changed = true;
+    }
+}
+
+void Memory::MapIORegister(u16 address, u8 read_mask, u8 write_mask) {
+    MapIORegister(address, nullptr, read_mask, write_mask);
+}
+
+void Memory::MapIORegister(u16 address, u8* storage, u8 read_mask, u8 write_mask) {
+    IORegister io;
+    io.storage = storage;
+    io.read_mask = read_mask;
+    io.write_mask = write_mask;
+    SetIORegister(address, io);
 }
 
-void Memory::RegisterIOHandler(u16 address, IOReadHandler read_handler, IOWriteHandler write_handler) {
+void Memory::SetIORegister(u16 address, IORegister io) {
     if (address < IO_START || address > IO_END) {
-        spdlog::warn("Attempted to register I/O handler for invalid address 0x{:04X}", address);
+        spdlog::warn("Attempted to map I/O register at invalid address 0x{:04X}", address);
         return;
     }
 
-    u16 offset = address - IO_START;
-    m_io_read_handlers[offset] = std::move(read_handler);
-    m_io_write_handlers[offset] = std::move(write_handler);
+    const u16 offset = address - IO_START;
+    if (!io.storage) {
+        io.storage = &m_io[offset];
+    }
+    m_io_registers[offset] = io;
+
+    spdlog::trace("Mapped I/O register 0x{:04X}", address);
+}
+
+u16 Memory::GetROMBank() const {
+    return m_mbc ? m_mbc->GetROMBank() : 1;
+}
+
+void Memory::ProtectCodePage(u8 page) {
+    const u8 index = CodePageIndex(page);
+
+    // Protect the page together with its echo RAM alias, if any
+    for (u8 alias : {index, EchoPageAlias(index)}) {
+        if (m_write_page_table[alias] != nullptr) {
+            m_code_page_table[alias] = m_write_page_table[alias];
+            m_write_page_table[alias] = nullptr;
+        }
+    }
+}
+
+void Memory::InvalidateCodePage(u8 page) {
+    const u8 index = CodePageIndex(page);
+    m_code_generation[index]++;
+
+    for (u8 alias : {index, EchoPageAlias(index)}) {
+        if (m_code_page_table[alias] != nullptr) {
+            m_write_page_table[alias] = m_code_page_table[alias];
+            m_code_page_table[alias] = nullptr;
+        }
+    }
 
-    spdlog::trace("Registered I/O handler for address 0x{:04X}", address);
+    LOG_TRACE("Code page 0x{:02X} written, cached blocks invalidated", index);
+    TRACE_RECORD(m_trace, TraceEvent::CODE_INVALIDATE, index);
 }
 
 void Memory::RequestInterrupt(u8 interrupt_bit) {
     // Directly set the bit in IF register (0xFF0F)
     // IF register is at offset 0x0F in the I/O region
     m_io[0x0F] |= interrupt_bit;
-    spdlog::trace("Interrupt requested: bit 0x{:02X}, IF now 0x{:02X}", interrupt_bit, m_io[0x0F]);
+    m_interrupt_state_changed = true;
+    LOG_TRACE("Interrupt requested: bit 0x{:02X}, IF now 0x{:02X}", interrupt_bit, m_io[0x0F]);
+    TRACE_RECORD(m_trace, TraceEvent::INTERRUPT_REQUEST, interrupt_bit);
 }
@@ -1,11 +1,11 @@
 #pragma once
 #include "../types.hpp"
+#include "mbc.hpp"
+#include "../perf/perf_counters.hpp"
+#include "../debug/trace_ring.hpp"
 #include <array>
-#include <functional>
 #include <memory>
-
-// Forward declarations
-class MBC;
+#include <type_traits>
 
 class Memory {
 public:
@@ -16,6 +16,7 @@ public:
     static constexpr u16 ROM_BANK_N_END   = 0x7FFF;
     static constexpr u16 VRAM_START       = 0x8000;
     static constexpr u16 VRAM_END         = 0x9FFF;
+    static constexpr u16 TILE_DATA_END    = 0x97FF;
     static constexpr u16 EXTERNAL_RAM_START = 0xA000;
     static constexpr u16 EXTERNAL_RAM_END   = 0xBFFF;
     static constexpr u16 WRAM_START       = 0xC000;
@@ -39,10 +40,18 @@ public:
     static constexpr size_t HRAM_SIZE  = 127;    // 127 bytes
     static constexpr size_t IO_SIZE    = 128;    // 128 bytes
 
+    // VRAM tile data: 384 tiles of 16 bytes
+    static constexpr size_t TILE_SIZE  = 16;
+    static constexpr size_t TILE_COUNT = (TILE_DATA_END - VRAM_START + 1) / TILE_SIZE;
+
     // Software fastmem page table configuration
     static constexpr size_t PAGE_SIZE = 256;     // 256 bytes per page
     static constexpr size_t PAGE_COUNT = 256;    // 64KB / 256 = 256 pages
 
+    // Pages 0xFE-0xFF mix OAM, I/O and HRAM, so they get a finer table
+    static constexpr size_t SUBPAGE_SIZE = 32;
+    static constexpr size_t SUBPAGE_COUNT = (0x10000 - OAM_START) / SUBPAGE_SIZE;
+
     Memory();
     ~Memory();
 
@@ -54,7 +63,9 @@ public:
     u16 Read16(u16 address) const;
     void Write16(u16 address, u16 value);
 
-    // Load ROM data
+    // Load ROM data. The image is shared, not copied; the pointer overload
+    // makes a private image from the bytes.
+    bool LoadROM(std::shared_ptr<const ROMImage> rom);
     bool LoadROM(const u8* data, size_t size);
 
     // Direct memory access (for debugging/testing)
@@ -66,42 +77,198 @@ public:
     // Reset memory
     void Reset();
 
-    // I/O register handler types
-    using IOReadHandler = std::function<u8(u16)>;
-    using IOWriteHandler = std::function<void(u16, u8)>;
+    // Save state: internal memory, I/O buffer and MBC bank registers.
+    // Cartridge RAM is large and optional, so it is copied separately.
+    struct State {
+        std::array<u8, WRAM_SIZE> wram;
+        std::array<u8, VRAM_SIZE> vram;
+        std::array<u8, OAM_SIZE> oam;
+        std::array<u8, HRAM_SIZE + 1> hram;  // Including IE
+        std::array<u8, IO_SIZE> io;
+        MBC::State mbc;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
+
+    // Cartridge RAM of the loaded MBC (nullptr/0 without a cartridge)
+    u8* GetCartridgeRAM() { return m_mbc ? m_mbc->GetRAMData() : nullptr; }
+    const u8* GetCartridgeRAM() const { return m_mbc ? m_mbc->GetRAMData() : nullptr; }
+    size_t GetCartridgeRAMSize() const { return m_mbc ? m_mbc->GetRAMSize() : 0; }
+
+    // I/O register dispatch. Every register in 0xFF00-0xFF7F is one flat
+    // table entry: a backing byte with read/write masks, optionally replaced
+    // by plain function pointers that call into the owning component.
+    using IOReadFunction = u8 (*)(void* context, u16 address);
+    using IOWriteFunction = void (*)(void* context, u16 address, u8 value);
+
+    struct IORegister {
+        u8* storage = nullptr;            // Backing byte (m_io unless a component owns it)
+        IOReadFunction read = nullptr;    // Replaces the storage read when set
+        IOWriteFunction write = nullptr;  // Replaces the storage write when set
+        void* context = nullptr;          // Passed to read/write
+        u8 read_mask = 0x00;              // Bits that always read as 1
+        u8 write_mask = 0xFF;             // Bits a storage write may change
+    };
+
+    // Plain register kept in the I/O buffer
+    void MapIORegister(u16 address, u8 read_mask = 0x00, u8 write_mask = 0xFF);
 
-    // Register I/O handlers (public so PPU/APU can register)
-    void RegisterIOHandler(u16 address, IOReadHandler read_handler, IOWriteHandler write_handler);
+    // Plain register stored in a component's own byte
+    void MapIORegister(u16 address, u8* storage, u8 read_mask = 0x00, u8 write_mask = 0xFF);
+
+    // Register with side effects: READ (u8 Owner::*()) and WRITE (void Owner::*(u8))
+    // are member functions called directly on owner. Either may be nullptr to
+    // fall back to storage (or the I/O buffer) for that direction.
+    template <auto READ, auto WRITE, typename Owner>
+    void MapIOHandler(u16 address, Owner* owner, u8* storage = nullptr, u8 read_mask = 0x00) {
+        IORegister io;
+        io.storage = storage;
+        io.context = owner;
+        io.read_mask = read_mask;
+
+        if constexpr (!std::is_null_pointer_v<decltype(READ)>) {
+            io.read = [](void* context, u16) -> u8 {
+                return (static_cast<Owner*>(context)->*READ)();
+            };
+        }
+        if constexpr (!std::is_null_pointer_v<decltype(WRITE)>) {
+            io.write = [](void* context, u16, u8 value) {
+                (static_cast<Owner*>(context)->*WRITE)(value);
+            };
+        }
+
+        SetIORegister(address, io);
+    }
 
     // Request interrupt (sets bit in IF register)
     void RequestInterrupt(u8 interrupt_bit);
 
+    // Interrupts requested and enabled (IF & IE)
+    u8 GetPendingInterrupts() const { return m_io[0x0F] & m_hram[IE_OFFSET] & 0x1F; }
+
+    // Set on every IF/IE change (and by the CPU when IME or HALT change); the
+    // CPU only re-evaluates interrupts while this is set
+    bool HasInterruptStateChanged() const { return m_interrupt_state_changed; }
+    void MarkInterruptStateChanged() { m_interrupt_state_changed = true; }
+    void ClearInterruptStateChanged() { m_interrupt_state_changed = false; }
+
+    // Tiles whose data has been written since the PPU last decoded them, one
+    // bit per tile. Tile data pages take the slow write path to keep this up
+    // to date; anything writing VRAM directly must call MarkAllTilesDirty.
+    using TileDirtyMask = std::array<u64, TILE_COUNT / 64>;
+    TileDirtyMask& GetDirtyTiles() { return m_dirty_tiles; }
+    void MarkAllTilesDirty() { m_dirty_tiles.fill(~0ull); }
+
+    // Set on every OAM change, for the PPU's per-line sprite index. OAM takes
+    // the slow write path to keep this up to date; anything writing OAM
+    // directly (DMA) must call MarkOAMDirty.
+    bool IsOAMDirty() const { return m_oam_dirty; }
+    void MarkOAMDirty() { m_oam_dirty = true; }
+    void ClearOAMDirty() { m_oam_dirty = false; }
+
+    // ROM bank currently mapped at 0x4000-0x7FFF
+    u16 GetROMBank() const;
+
+    // Whether a page is served straight from the fastmem tables
+    bool IsPageMapped(u8 page) const { return m_read_page_table[page] != nullptr; }
+    const u8* GetReadPage(u8 page) const { return m_read_page_table[page]; }
+
+    // OAM DMA lockout: while locked, CPU reads of OAM return 0xFF and writes
+    // are dropped (GetOAM() is unaffected). Reset and LoadState unlock.
+    void SetOAMLocked(bool locked);
+
+    // Code invalidation for the CPU block cache. Protecting a page routes its
+    // writes through the slow path, where the first store bumps the page's
+    // code generation and lifts the protection again.
+    void ProtectCodePage(u8 page);
+    const u32& GetCodeGeneration(u8 page) const { return m_code_generation[CodePageIndex(page)]; }
+
+#if DMWSS_PERF_COUNTERS
+    const perf::MemoryCounters& GetPerfCounters() const { return m_perf; }
+    void ResetPerfCounters() { m_perf = {}; }
+#endif
+
+#if DMWSS_TRACE_RING
+    // Record interrupt requests and code invalidations into ring (nullptr: stop)
+    void SetTraceRing(TraceRing* ring) { m_trace = ring; }
+#endif
+
 private:
     // Memory regions (SIMD-aligned for performance)
     ALIGN(64) std::array<u8, WRAM_SIZE> m_wram;   // Work RAM
     ALIGN(64) std::array<u8, VRAM_SIZE> m_vram;   // Video RAM
     ALIGN(64) std::array<u8, OAM_SIZE> m_oam;     // OAM (Sprite attribute table)
-    ALIGN(64) std::array<u8, HRAM_SIZE> m_hram;   // High RAM
+    ALIGN(64) std::array<u8, HRAM_SIZE + 1> m_hram;  // High RAM, IE register in the last byte
     ALIGN(64) std::array<u8, IO_SIZE> m_io;       // I/O registers
 
-    u8 m_ie_register;  // Interrupt Enable register (0xFFFF)
+    static constexpr size_t IE_OFFSET = IE_REGISTER - HRAM_START;
+
+    bool m_interrupt_state_changed;
+    TileDirtyMask m_dirty_tiles;
+    bool m_oam_dirty;
+    bool m_oam_locked;
 
     // Software fastmem page tables
     // Each entry points to the start of a page, or nullptr for I/O regions
-    std::array<u8*, PAGE_COUNT> m_read_page_table;
+    std::array<const u8*, PAGE_COUNT> m_read_page_table;
     std::array<u8*, PAGE_COUNT> m_write_page_table;
 
-    // Memory Bank Controller (for ROM banking)
-    std::unique_ptr<MBC> m_mbc;
+    // Sub-page tables for 0xFE00-0xFFFF (OAM and HRAM; nullptr for I/O)
+    std::array<const u8*, SUBPAGE_COUNT> m_read_subpage_table;
+    std::array<u8*, SUBPAGE_COUNT> m_write_subpage_table;
+
+    // Write-protected code pages: saved fastmem write pointers (nullptr if unprotected)
+    std::array<u8*, PAGE_COUNT> m_code_page_table;
+    std::array<u32, PAGE_COUNT> m_code_generation;
+
+    // Memory Bank Controller (for ROM banking), held by value; empty without a cartridge
+    std::optional<MBC> m_mbc;
 
     // Initialize page tables
     void InitializePageTables();
 
+    // Publish the MBC's current ROM/RAM banks into the page tables
+    void MapCartridgeBanks();
+
+    // Aliased pages share one code generation: the switchable ROM bank is
+    // tracked as a whole, and echo RAM follows the WRAM it mirrors
+    static constexpr u8 CodePageIndex(u8 page) {
+        if (page >= (ROM_BANK_N_START >> 8) && page <= (ROM_BANK_N_END >> 8)) {
+            return ROM_BANK_N_START >> 8;
+        }
+        if (page >= (ECHO_RAM_START >> 8) && page <= (ECHO_RAM_END >> 8)) {
+            return page - ((ECHO_RAM_START - WRAM_START) >> 8);
+        }
+        return page;
+    }
+
+    // Echo RAM page mirroring a WRAM page (the page itself if there is none)
+    static constexpr u8 EchoPageAlias(u8 page) {
+        const u8 echo = page + ((ECHO_RAM_START - WRAM_START) >> 8);
+        if (page >= (WRAM_START >> 8) && echo <= (ECHO_RAM_END >> 8)) {
+            return echo;
+        }
+        return page;
+    }
+
+    void InvalidateCodePage(u8 page);
+
     // Slow path handlers for I/O and unmapped regions
     u8 ReadIO(u16 address) const;
     void WriteIO(u16 address, u8 value);
 
-    // I/O register handler storage
-    std::array<IOReadHandler, IO_SIZE> m_io_read_handlers;
-    std::array<IOWriteHandler, IO_SIZE> m_io_write_handlers;
+    // Install an I/O table entry (nullptr storage means the I/O buffer)
+    void SetIORegister(u16 address, IORegister io);
+
+    // I/O register dispatch table, indexed by address - IO_START
+    std::array<IORegister, IO_SIZE> m_io_registers;
+
+#if DMWSS_PERF_COUNTERS
+    mutable perf::MemoryCounters m_perf;
+#endif
+
+#if DMWSS_TRACE_RING
+    TraceRing* m_trace = nullptr;
+#endif
 };
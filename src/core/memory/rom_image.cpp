@@ -0,0 +1,148 @@
+#include "rom_image.hpp"
+#include <spdlog/spdlog.h>
+#include <fstream>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #define DMWSS_ROM_MMAP_WIN32
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define DMWSS_ROM_MMAP_POSIX
+#endif
+
+namespace {
+
+// Map a whole file read-only. Returns nullptr (without logging) when mapping
+// isn't possible, so the caller can fall back to reading it.
+void* MapFile(const std::string& path, size_t& size) {
+#if defined(DMWSS_ROM_MMAP_POSIX)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    void* view = nullptr;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size >= static_cast<off_t>(ROMImage::MIN_SIZE)) {
+        size = static_cast<size_t>(info.st_size);
+        view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) view = nullptr;
+    }
+
+    close(fd);  // The mapping keeps its own reference to the file
+    return view;
+#elif defined(DMWSS_ROM_MMAP_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    void* view = nullptr;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart >= static_cast<LONGLONG>(ROMImage::MIN_SIZE)) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            size = static_cast<size_t>(file_size.QuadPart);
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);  // The view keeps the mapping alive
+        }
+    }
+
+    CloseHandle(file);
+    return view;
+#else
+    (void)path;
+    (void)size;
+    return nullptr;
+#endif
+}
+
+void UnmapFile(void* view, size_t size) {
+#if defined(DMWSS_ROM_MMAP_POSIX)
+    munmap(view, size);
+#elif defined(DMWSS_ROM_MMAP_WIN32)
+    (void)size;
+    UnmapViewOfFile(view);
+#else
+    (void)view;
+    (void)size;
+#endif
+}
+
+}  // namespace
+
+ROMImage::ROMImage(std::vector<u8> buffer)
+    : m_buffer(std::move(buffer))
+    , m_mapping(nullptr)
+    , m_data(m_buffer.data())
+    , m_size(m_buffer.size())
+    , m_header{} {
+    ParseHeader();
+}
+
+ROMImage::ROMImage(void* mapping, size_t size)
+    : m_mapping(mapping)
+    , m_data(static_cast<const u8*>(mapping))
+    , m_size(size)
+    , m_header{} {
+    ParseHeader();
+}
+
+ROMImage::~ROMImage() {
+    if (m_mapping) {
+        UnmapFile(m_mapping, m_size);
+    }
+}
+
+void ROMImage::ParseHeader() {
+    for (size_t i = 0; i < 16; i++) {
+        const char c = static_cast<char>(m_data[0x134 + i]);
+        if (c == 0) break;  // Null terminator
+        m_header.title += c;
+    }
+
+    m_header.cartridge_type = m_data[0x147];
+    m_header.rom_size_code = m_data[0x148];
+    m_header.ram_size_code = m_data[0x149];
+    m_header.global_checksum = static_cast<u16>((m_data[0x14E] << 8) | m_data[0x14F]);
+}
+
+std::shared_ptr<const ROMImage> ROMImage::FromData(std::vector<u8> data) {
+    if (data.size() < MIN_SIZE) {
+        spdlog::error("ROM too small (< 0x150 bytes)");
+        return nullptr;
+    }
+
+    return std::shared_ptr<const ROMImage>(new ROMImage(std::move(data)));
+}
+
+std::shared_ptr<const ROMImage> ROMImage::FromFile(const std::string& path) {
+    size_t mapped_size = 0;
+    if (void* view = MapFile(path, mapped_size)) {
+        return std::shared_ptr<const ROMImage>(new ROMImage(view, mapped_size));
+    }
+
+    // No mmap on this platform, or not a mappable file: read it instead
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        spdlog::error("Failed to open ROM file: {}", path);
+        return nullptr;
+    }
+
+    const std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<u8> data(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
+        spdlog::error("Failed to read ROM file: {}", path);
+        return nullptr;
+    }
+
+    return FromData(std::move(data));
+}
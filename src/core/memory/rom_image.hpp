@@ -0,0 +1,50 @@
+#pragma once
+#include "../types.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Immutable cartridge ROM. Every instance running the same game shares one
+// image through a shared_ptr; the MBC reads it in place instead of keeping
+// its own copy. The header is parsed once when the image is created.
+//
+// FromFile maps the file read-only where the platform supports it, so loading
+// is O(1) and processes running the same ROM share its pages through the OS
+// page cache. The file must not be truncated while it is mapped.
+class ROMImage {
+public:
+    struct Header {
+        std::string title;
+        u8 cartridge_type;
+        u8 rom_size_code;      // 0x0148: 32KB << code
+        u8 ram_size_code;      // 0x0149
+        u16 global_checksum;   // 0x014E-0x014F, big-endian in the ROM
+    };
+
+    static constexpr size_t MIN_SIZE = 0x150;  // Through the end of the header
+
+    // Both return nullptr (and log why) if the data can't be a ROM
+    static std::shared_ptr<const ROMImage> FromData(std::vector<u8> data);
+    static std::shared_ptr<const ROMImage> FromFile(const std::string& path);
+
+    ~ROMImage();
+    ROMImage(const ROMImage&) = delete;
+    ROMImage& operator=(const ROMImage&) = delete;
+
+    const u8* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    const Header& GetHeader() const { return m_header; }
+    bool IsMapped() const { return m_mapping != nullptr; }
+
+private:
+    explicit ROMImage(std::vector<u8> buffer);
+    ROMImage(void* mapping, size_t size);
+
+    void ParseHeader();
+
+    std::vector<u8> m_buffer;  // Owned bytes when the image isn't mapped
+    void* m_mapping;           // Read-only file view, or nullptr
+    const u8* m_data;
+    size_t m_size;
+    Header m_header;
+};
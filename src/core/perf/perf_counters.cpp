@@ -0,0 +1,23 @@
+#include "perf_counters.hpp"
+
+namespace perf {
+
+const char* RegionName(Region region) {
+    switch (region) {
+        case Region::ROM0:         return "rom0";
+        case Region::ROMX:         return "romx";
+        case Region::VRAM:         return "vram";
+        case Region::EXTERNAL_RAM: return "external_ram";
+        case Region::WRAM:         return "wram";
+        case Region::ECHO_RAM:     return "echo_ram";
+        case Region::OAM:          return "oam";
+        case Region::UNUSABLE:     return "unusable";
+        case Region::IO:           return "io";
+        case Region::HRAM:         return "hram";
+        case Region::IE:           return "ie";
+        case Region::COUNT:        break;
+    }
+    return "unknown";
+}
+
+}  // namespace perf
@@ -0,0 +1,132 @@
+#pragma once
+#include "../types.hpp"
+#include <array>
+#include <chrono>
+
+// Hot-path instrumentation, compiled in with -DDMWSS_PERF_COUNTERS=ON. Each
+// component keeps its own counters (so forked and batched instances never
+// share them) and GameBoy::GetPerfStats() collects them. When disabled the
+// members and macros below vanish entirely: the hot paths compile to exactly
+// what they were without them.
+#ifndef DMWSS_PERF_COUNTERS
+#define DMWSS_PERF_COUNTERS 0
+#endif
+
+#if DMWSS_PERF_COUNTERS
+#define PERF_COUNT(counter) (++(counter))
+#define PERF_SCOPED_TIMER(stats) PerfScopedTimer perf_scoped_timer_(stats)
+#else
+#define PERF_COUNT(counter) ((void)0)
+#define PERF_SCOPED_TIMER(stats) ((void)0)
+#endif
+
+namespace perf {
+
+inline constexpr bool ENABLED = DMWSS_PERF_COUNTERS != 0;
+
+// Address space split the way the memory map is documented
+enum class Region : u8 {
+    ROM0,
+    ROMX,
+    VRAM,
+    EXTERNAL_RAM,
+    WRAM,
+    ECHO_RAM,
+    OAM,
+    UNUSABLE,
+    IO,
+    HRAM,
+    IE,
+    COUNT
+};
+
+inline constexpr size_t REGION_COUNT = static_cast<size_t>(Region::COUNT);
+
+constexpr Region RegionOf(u16 address) {
+    if (address < 0x4000) return Region::ROM0;
+    if (address < 0x8000) return Region::ROMX;
+    if (address < 0xA000) return Region::VRAM;
+    if (address < 0xC000) return Region::EXTERNAL_RAM;
+    if (address < 0xE000) return Region::WRAM;
+    if (address < 0xFE00) return Region::ECHO_RAM;
+    if (address < 0xFEA0) return Region::OAM;
+    if (address < 0xFF00) return Region::UNUSABLE;
+    if (address < 0xFF80) return Region::IO;
+    if (address < 0xFFFF) return Region::HRAM;
+    return Region::IE;
+}
+
+constexpr size_t RegionIndex(u16 address) {
+    return static_cast<size_t>(RegionOf(address));
+}
+
+const char* RegionName(Region region);
+
+struct CPUCounters {
+    std::array<u64, 256> opcodes{};     // Primary opcodes (0xCB counts the prefix)
+    std::array<u64, 256> cb_opcodes{};
+    u64 blocks = 0;                     // Blocks entered from the cache
+    u64 uncached_instructions = 0;      // Decoded on the spot (HRAM, I/O, page straddles)
+    u64 block_compiles = 0;
+};
+
+struct MemoryCounters {
+    // Indexed by Region; fast = served from the page or sub-page tables
+    std::array<u64, REGION_COUNT> fast_reads{};
+    std::array<u64, REGION_COUNT> slow_reads{};
+    std::array<u64, REGION_COUNT> fast_writes{};
+    std::array<u64, REGION_COUNT> slow_writes{};
+
+    // Dispatches per I/O register (0xFF00 + index)
+    std::array<u64, 0x80> io_reads{};
+    std::array<u64, 0x80> io_writes{};
+};
+
+inline constexpr size_t MAX_EVENT_TYPES = 16;
+
+struct SchedulerCounters {
+    std::array<u64, MAX_EVENT_TYPES> events{};  // Fired per Scheduler::EventType
+};
+
+struct TimeCounter {
+    u64 calls = 0;
+    u64 nanoseconds = 0;
+};
+
+struct PPUCounters {
+    TimeCounter render_scanline;  // Drawn lines only
+};
+
+}  // namespace perf
+
+// Everything GameBoy::GetPerfStats() reports; all zero when compiled out
+struct PerfStats {
+    bool enabled = perf::ENABLED;
+    perf::CPUCounters cpu;
+    perf::MemoryCounters memory;
+    perf::SchedulerCounters scheduler;
+    perf::PPUCounters ppu;
+};
+
+#if DMWSS_PERF_COUNTERS
+class PerfScopedTimer {
+public:
+    explicit PerfScopedTimer(perf::TimeCounter& counter)
+        : m_counter(counter), m_start(std::chrono::steady_clock::now()) {
+    }
+
+    ~PerfScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_counter.calls++;
+        m_counter.nanoseconds += static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    PerfScopedTimer(const PerfScopedTimer&) = delete;
+    PerfScopedTimer& operator=(const PerfScopedTimer&) = delete;
+
+private:
+    perf::TimeCounter& m_counter;
+    std::chrono::steady_clock::time_point m_start;
+};
+#endif
@@ -0,0 +1,89 @@
+#include "compositor.hpp"
+
+#if defined(__SSE4_1__) || defined(__AVX2__)
+    #include <immintrin.h>
+    #define DMWSS_COMPOSITOR_SSE41
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define DMWSS_COMPOSITOR_NEON
+#endif
+
+namespace {
+
+constexpr size_t VECTOR_WIDTH = 16;  // Pixels per vector iteration
+
+// Final palette index: BG color id, or 4 + OBJ palette/color bits
+FORCE_INLINE u8 ComposePixel(u8 bg, u8 obj) {
+    const bool visible = (obj & OBJ_COLOR_MASK) != 0;
+    const bool hidden = (obj & OBJ_BEHIND_BG) != 0 && bg != 0;
+    return (visible && !hidden) ? static_cast<u8>(4 + (obj & (OBJ_PALETTE_1 | OBJ_COLOR_MASK))) : bg;
+}
+
+}  // namespace
+
+void ComposeScanline(u8* out, const u8* bg_line, const u8* obj_line,
+                     const LinePalette& palette, size_t width) {
+    size_t x = 0;
+
+#if defined(DMWSS_COMPOSITOR_SSE41)
+    const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette.data()));
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color_mask = _mm_set1_epi8(OBJ_COLOR_MASK);
+    const __m128i index_mask = _mm_set1_epi8(OBJ_PALETTE_1 | OBJ_COLOR_MASK);
+    const __m128i behind_mask = _mm_set1_epi8(static_cast<char>(OBJ_BEHIND_BG));
+    const __m128i obj_base = _mm_set1_epi8(4);
+
+    for (; x + VECTOR_WIDTH <= width; x += VECTOR_WIDTH) {
+        const __m128i bg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bg_line + x));
+        const __m128i obj = _mm_loadu_si128(reinterpret_cast<const __m128i*>(obj_line + x));
+
+        // Transparent sprite pixels, and behind-BG pixels over BG colors 1-3
+        const __m128i transparent = _mm_cmpeq_epi8(_mm_and_si128(obj, color_mask), zero);
+        const __m128i behind = _mm_cmpeq_epi8(_mm_and_si128(obj, behind_mask), behind_mask);
+        const __m128i bg_opaque = _mm_xor_si128(_mm_cmpeq_epi8(bg, zero), _mm_set1_epi8(-1));
+        const __m128i use_bg = _mm_or_si128(transparent, _mm_and_si128(behind, bg_opaque));
+
+        const __m128i obj_index = _mm_add_epi8(_mm_and_si128(obj, index_mask), obj_base);
+        const __m128i index = _mm_blendv_epi8(obj_index, bg, use_bg);
+
+        // The whole palette fits one 16-entry byte lookup
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_shuffle_epi8(lut, index));
+    }
+#elif defined(DMWSS_COMPOSITOR_NEON)
+    const uint8x16_t lut = vld1q_u8(palette.data());
+
+    const uint8x16_t color_mask = vdupq_n_u8(OBJ_COLOR_MASK);
+    const uint8x16_t index_mask = vdupq_n_u8(OBJ_PALETTE_1 | OBJ_COLOR_MASK);
+    const uint8x16_t behind_mask = vdupq_n_u8(OBJ_BEHIND_BG);
+    const uint8x16_t obj_base = vdupq_n_u8(4);
+
+    for (; x + VECTOR_WIDTH <= width; x += VECTOR_WIDTH) {
+        const uint8x16_t bg = vld1q_u8(bg_line + x);
+        const uint8x16_t obj = vld1q_u8(obj_line + x);
+
+        // Transparent sprite pixels, and behind-BG pixels over BG colors 1-3
+        const uint8x16_t transparent = vceqzq_u8(vandq_u8(obj, color_mask));
+        const uint8x16_t behind = vtstq_u8(obj, behind_mask);
+        const uint8x16_t bg_opaque = vtstq_u8(bg, bg);
+        const uint8x16_t use_bg = vorrq_u8(transparent, vandq_u8(behind, bg_opaque));
+
+        const uint8x16_t obj_index = vaddq_u8(vandq_u8(obj, index_mask), obj_base);
+        const uint8x16_t index = vbslq_u8(use_bg, bg, obj_index);
+
+        // The whole palette fits one 16-entry byte lookup
+        vst1q_u8(out + x, vqtbl1q_u8(lut, index));
+    }
+#endif
+
+    // Scalar path (and the tail of the vector paths)
+    for (; x < width; x++) {
+        out[x] = palette[ComposePixel(bg_line[x], obj_line[x])];
+    }
+}
+
+void ExpandShades(u32* out, const u8* shades, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = SHADE_COLORS[shades[i] & 0x03];
+    }
+}
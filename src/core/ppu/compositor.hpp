@@ -0,0 +1,26 @@
+#pragma once
+#include "../types.hpp"
+
+// Scanline compositor: merges the PPU's BG/window and OBJ color-index lines
+// and maps the result through the palettes to 2-bit shades. Uses SSE4.1 or
+// NEON when the build targets them, scalar code otherwise.
+
+// Shade -> ARGB: white, light gray, dark gray, black
+constexpr std::array<u32, 4> SHADE_COLORS = {0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFF000000};
+
+// Palette for one line, index -> shade: 0-3 BG/window, 4-7 OBP0, 8-11 OBP1
+// (12-15 unused)
+using LinePalette = std::array<u8, 16>;
+
+// OBJ line byte layout; 0 means no sprite pixel
+constexpr u8 OBJ_COLOR_MASK = 0x03;    // Color id 1-3
+constexpr u8 OBJ_PALETTE_1 = 0x04;     // Uses OBP1
+constexpr u8 OBJ_BEHIND_BG = 0x80;     // Only shows over BG color 0
+
+// Compose width shades into out. A sprite pixel wins unless it is marked
+// behind the BG and the BG color id there is non-zero.
+void ComposeScanline(u8* out, const u8* bg_line, const u8* obj_line,
+                     const LinePalette& palette, size_t width);
+
+// Map count shades to ARGB through SHADE_COLORS
+void ExpandShades(u32* out, const u8* shades, size_t count);
@@ -7,10 +7,16 @@ PPU::PPU(Memory& memory, Scheduler& scheduler)
     : m_memory(memory)
     , m_scheduler(scheduler)
     , m_mode(Mode::OAM_SCAN)
-    , m_cycle_counter(0)
     , m_scanline(0)
     , m_frame_ready(false)
+    , m_render_policy(RenderPolicy::FULL)
+    , m_frame_interval(1)
+    , m_frame_counter(0)
+    , m_render_frame(true)
+    , m_draw_until_cycle(0)
+    , m_framebuffer_stale(true)
     , m_sprite_count(0)
+    , m_sprite_index_height(0)
     , m_lcdc(0x91)
     , m_stat(0x00)
     , m_scy(0)
@@ -21,101 +27,206 @@ PPU::PPU(Memory& memory, Scheduler& scheduler)
     , m_obp1(0xFF)
     , m_wy(0)
     , m_wx(0) {
+    m_scheduler.RegisterEvent(Scheduler::EventType::LCD_TRANSFER,
+        [](void* ppu) { static_cast<PPU*>(ppu)->OnLCDTransfer(); }, this);
+    m_scheduler.RegisterEvent(Scheduler::EventType::HBLANK,
+        [](void* ppu) { static_cast<PPU*>(ppu)->OnHBlank(); }, this);
+    m_scheduler.RegisterEvent(Scheduler::EventType::HBLANK_EXIT,
+        [](void* ppu) { static_cast<PPU*>(ppu)->OnHBlankExit(); }, this);
+    m_scheduler.RegisterEvent(Scheduler::EventType::VBLANK,
+        [](void* ppu) { static_cast<PPU*>(ppu)->OnVBlankLine(); }, this);
+
+    m_palette.fill(0);
+    SetPalette(0, m_bgp);
+    SetPalette(4, m_obp0);
+    SetPalette(8, m_obp1);
+
     Reset();
     RegisterIOHandlers();
 }
 
 void PPU::Reset() {
-    m_framebuffer.fill(0xFFFFFFFF);  // White
+    m_shades.fill(0);  // White
+    m_framebuffer_stale = true;
     m_mode = Mode::OAM_SCAN;
-    m_cycle_counter = 0;
     m_scanline = 0;
     m_frame_ready = false;
     m_sprite_count = 0;
+    m_sprite_index_height = 0;
+    m_draw_until_cycle = 0;
+
+    // Decode every tile again before the next line is drawn
+    m_memory.MarkAllTilesDirty();
+
+    StopLCD();
+    if (m_lcdc & LCDC_LCD_ENABLE) {
+        StartLCD();
+    }
 
     spdlog::debug("PPU reset");
 }
 
-void PPU::Step(u32 cycles) {
-    // If LCD is disabled, don't update
-    if ((m_lcdc & LCDC_LCD_ENABLE) == 0) {
-        return;
+void PPU::SaveState(State& state) const {
+    state.shades = m_shades;
+    state.sprite_buffer = m_sprite_buffer;
+    state.sprite_count = m_sprite_count;
+    state.mode = static_cast<u8>(m_mode);
+    state.scanline = m_scanline;
+    state.frame_ready = m_frame_ready;
+    state.lcdc = m_lcdc;
+    state.stat = m_stat;
+    state.scy = m_scy;
+    state.scx = m_scx;
+    state.lyc = m_lyc;
+    state.bgp = m_bgp;
+    state.obp0 = m_obp0;
+    state.obp1 = m_obp1;
+    state.wy = m_wy;
+    state.wx = m_wx;
+}
+
+void PPU::LoadState(const State& state) {
+    m_shades = state.shades;
+    m_framebuffer_stale = true;
+    m_sprite_buffer = state.sprite_buffer;
+    m_sprite_count = std::min<u8>(state.sprite_count, static_cast<u8>(m_sprite_buffer.size()));
+    m_sprite_index_height = 0;
+    m_draw_until_cycle = 0;
+    m_mode = static_cast<Mode>(state.mode & 0x03);
+    m_scanline = state.scanline;
+    m_frame_ready = state.frame_ready != 0;
+    m_lcdc = state.lcdc;
+    m_stat = state.stat;
+    m_scy = state.scy;
+    m_scx = state.scx;
+    m_lyc = state.lyc;
+    m_wy = state.wy;
+    m_wx = state.wx;
+
+    WriteBGP(state.bgp);
+    WriteOBP0(state.obp0);
+    WriteOBP1(state.obp1);
+}
+
+const u32* PPU::GetFramebuffer() const {
+    if (m_framebuffer_stale) {
+        ExpandShades(m_framebuffer.data(), m_shades.data(), m_shades.size());
+        m_framebuffer_stale = false;
     }
+    return m_framebuffer.data();
+}
 
-    m_cycle_counter += cycles;
-
-    switch (m_mode) {
-        case Mode::OAM_SCAN: {
-            if (m_cycle_counter >= OAM_SCAN_CYCLES) {
-                m_cycle_counter -= OAM_SCAN_CYCLES;
-                
-                // Scan OAM for sprites on this line
-                ScanOAM();
-                
-                // Move to drawing mode
-                SetMode(Mode::DRAWING);
-            }
-            break;
-        }
+void PPU::SetRenderPolicy(RenderPolicy policy, u32 frame_interval) {
+    m_render_policy = policy;
+    m_frame_interval = std::max(frame_interval, 1u);
+    m_frame_counter = 0;
 
-        case Mode::DRAWING: {
-            if (m_cycle_counter >= DRAWING_CYCLES) {
-                m_cycle_counter -= DRAWING_CYCLES;
-                
-                // Render the current scanline
-                RenderScanline();
-                
-                // Move to HBlank
-                SetMode(Mode::HBLANK);
-            }
-            break;
-        }
+    if (policy != RenderPolicy::EVERY_N_FRAMES) {
+        m_render_frame = policy == RenderPolicy::FULL;
+    }
+}
 
-        case Mode::HBLANK: {
-            if (m_cycle_counter >= HBLANK_CYCLES) {
-                m_cycle_counter -= HBLANK_CYCLES;
-                
-                // Move to next scanline
-                m_scanline++;
-                m_memory.Write(0xFF44, m_scanline);  // Update LY register
-                
-                // Check LYC=LY
-                UpdateStatRegister();
-                
-                if (m_scanline >= SCREEN_HEIGHT) {
-                    // Enter VBlank
-                    SetMode(Mode::VBLANK);
-                    m_frame_ready = true;
-                    
-                    // Request VBlank interrupt
-                    m_memory.Write(0xFF0F, m_memory.Read(0xFF0F) | 0x01);
-                } else {
-                    // Next scanline - go to OAM scan
-                    SetMode(Mode::OAM_SCAN);
-                }
-            }
-            break;
-        }
+void PPU::DrawNextFrame() {
+    m_draw_until_cycle = m_scheduler.GetCurrentCycle() + CYCLES_PER_SCANLINE * SCANLINES_PER_FRAME;
+    m_render_frame = true;
+}
 
-        case Mode::VBLANK: {
-            if (m_cycle_counter >= CYCLES_PER_SCANLINE) {
-                m_cycle_counter -= CYCLES_PER_SCANLINE;
-                
-                m_scanline++;
-                m_memory.Write(0xFF44, m_scanline);
-                
-                // Check LYC=LY
-                UpdateStatRegister();
-                
-                if (m_scanline >= SCANLINES_PER_FRAME) {
-                    // Frame complete, restart from scanline 0
-                    m_scanline = 0;
-                    m_memory.Write(0xFF44, m_scanline);
-                    SetMode(Mode::OAM_SCAN);
-                }
-            }
+void PPU::BeginFrame() {
+    switch (m_render_policy) {
+        case RenderPolicy::FULL:
+            m_render_frame = true;
             break;
-        }
+        case RenderPolicy::EVERY_N_FRAMES:
+            m_render_frame = (m_frame_counter % m_frame_interval) == 0;
+            break;
+        case RenderPolicy::TIMING_ONLY:
+            m_render_frame = false;
+            break;
+    }
+    if (m_scheduler.GetCurrentCycle() < m_draw_until_cycle) {
+        m_render_frame = true;
+    }
+    m_frame_counter++;
+}
+
+void PPU::StartLCD() {
+    // The LCD restarts from the top of the frame
+    m_scanline = 0;
+    BeginFrame();
+    UpdateStatRegister();
+    EnterOAMScan();
+}
+
+void PPU::StopLCD() {
+    // A disabled LCD sits at LY=0 in HBlank with no mode events pending
+    m_scheduler.Deschedule(Scheduler::EventType::LCD_TRANSFER);
+    m_scheduler.Deschedule(Scheduler::EventType::HBLANK);
+    m_scheduler.Deschedule(Scheduler::EventType::HBLANK_EXIT);
+    m_scheduler.Deschedule(Scheduler::EventType::VBLANK);
+
+    m_scanline = 0;
+    m_mode = Mode::HBLANK;
+    m_stat &= ~STAT_MODE_FLAG;
+}
+
+void PPU::EnterOAMScan() {
+    SetMode(Mode::OAM_SCAN);
+    m_scheduler.Schedule(Scheduler::EventType::LCD_TRANSFER, OAM_SCAN_CYCLES);
+}
+
+void PPU::OnLCDTransfer() {
+    // Scan OAM for sprites on this line
+    ScanOAM();
+
+    // Move to drawing mode
+    SetMode(Mode::DRAWING);
+    m_scheduler.Schedule(Scheduler::EventType::HBLANK, DRAWING_CYCLES);
+}
+
+void PPU::OnHBlank() {
+    // Render the current scanline
+    RenderScanline();
+
+    // Move to HBlank
+    SetMode(Mode::HBLANK);
+    m_scheduler.Schedule(Scheduler::EventType::HBLANK_EXIT, HBLANK_CYCLES);
+}
+
+void PPU::OnHBlankExit() {
+    // Move to next scanline
+    m_scanline++;
+
+    // Check LYC=LY
+    UpdateStatRegister();
+
+    if (m_scanline >= SCREEN_HEIGHT) {
+        // Enter VBlank
+        SetMode(Mode::VBLANK);
+        m_frame_ready = true;
+
+        // Request VBlank interrupt
+        m_memory.RequestInterrupt(0x01);
+
+        m_scheduler.Schedule(Scheduler::EventType::VBLANK, CYCLES_PER_SCANLINE);
+    } else {
+        // Next scanline - go to OAM scan
+        EnterOAMScan();
+    }
+}
+
+void PPU::OnVBlankLine() {
+    m_scanline++;
+
+    if (m_scanline >= SCANLINES_PER_FRAME) {
+        // Frame complete, restart from scanline 0
+        m_scanline = 0;
+        BeginFrame();
+        UpdateStatRegister();
+        EnterOAMScan();
+    } else {
+        // Check LYC=LY
+        UpdateStatRegister();
+        m_scheduler.Schedule(Scheduler::EventType::VBLANK, CYCLES_PER_SCANLINE);
     }
 }
 
@@ -124,7 +235,6 @@ void PPU::SetMode(Mode mode) {
     
     // Update STAT register mode bits
     m_stat = (m_stat & 0xFC) | static_cast<u8>(mode);
-    m_memory.Write(0xFF41, m_stat);
     
     // Check for STAT interrupts
     bool request_stat_int = false;
@@ -144,7 +254,7 @@ void PPU::SetMode(Mode mode) {
     }
     
     if (request_stat_int) {
-        m_memory.Write(0xFF0F, m_memory.Read(0xFF0F) | 0x02);  // STAT interrupt
+        m_memory.RequestInterrupt(0x02);  // STAT interrupt
     }
 }
 
@@ -157,103 +267,114 @@ void PPU::UpdateStatRegister() {
         
         // Request LYC interrupt if enabled
         if (m_stat & STAT_LYC_INT) {
-            m_memory.Write(0xFF0F, m_memory.Read(0xFF0F) | 0x02);
+            m_memory.RequestInterrupt(0x02);
         }
     } else {
         m_stat &= ~STAT_LYC_EQUAL;
     }
-    
-    m_memory.Write(0xFF41, m_stat);
 }
 
 void PPU::ScanOAM() {
-    m_sprite_count = 0;
-    
-    // Get OAM data
-    u8* oam = m_memory.GetOAM();
-    
     // Sprite height (8 or 16 pixels)
-    u8 sprite_height = (m_lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
-    
-    // Scan all 40 sprites
-    for (u8 i = 0; i < 40 && m_sprite_count < 10; i++) {
+    const u8 sprite_height = (m_lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
+
+    if (m_scanline >= SCREEN_HEIGHT) {
+        m_sprite_count = 0;
+        return;
+    }
+
+    if (m_memory.IsOAMDirty() || sprite_height != m_sprite_index_height) {
+        BuildSpriteIndex(sprite_height);
+    }
+
+    m_sprite_count = m_line_sprite_counts[m_scanline];
+    std::copy_n(m_line_sprites[m_scanline].begin(), m_sprite_count, m_sprite_buffer.begin());
+}
+
+void PPU::BuildSpriteIndex(u8 sprite_height) {
+    m_line_sprite_counts.fill(0);
+
+    // Each sprite joins the lines it covers, in OAM order, while they have room
+    const u8* oam = m_memory.GetOAM();
+    for (u8 i = 0; i < 40; i++) {
         Sprite sprite;
         sprite.y = oam[i * 4 + 0];
         sprite.x = oam[i * 4 + 1];
         sprite.tile = oam[i * 4 + 2];
         sprite.flags = oam[i * 4 + 3];
-        
-        // Check if sprite is on this scanline
-        s16 sprite_y = sprite.y - 16;
-        s16 scanline = m_scanline;
-        
-        if (scanline >= sprite_y && scanline < sprite_y + sprite_height) {
-            m_sprite_buffer[m_sprite_count++] = sprite;
+
+        const s32 sprite_y = sprite.y - 16;
+        const s32 first = std::max(sprite_y, 0);
+        const s32 last = std::min(sprite_y + sprite_height, static_cast<s32>(SCREEN_HEIGHT));
+
+        for (s32 line = first; line < last; line++) {
+            u8& count = m_line_sprite_counts[line];
+            if (count < m_line_sprites[line].size()) {
+                m_line_sprites[line][count++] = sprite;
+            }
         }
     }
+
+    m_sprite_index_height = sprite_height;
+    m_memory.ClearOAMDirty();
 }
 
 void PPU::RenderScanline() {
-    // Only render visible scanlines
-    if (m_scanline >= SCREEN_HEIGHT) {
+    // Only render visible scanlines of frames the render policy draws
+    if (m_scanline >= SCREEN_HEIGHT || !m_render_frame) {
         return;
     }
-    
-    // Render layers
+
+    PERF_SCOPED_TIMER(m_perf.render_scanline);
+
+    UpdateTileCache();
+
+    // Build the color-index lines. With LCDC bit 0 clear the BG and window
+    // are blank (color 0) and shown white regardless of BGP.
     if (m_lcdc & LCDC_BG_ENABLE) {
         RenderBackground(m_scanline);
+
+        if (m_lcdc & LCDC_WIN_ENABLE) {
+            RenderWindow(m_scanline);
+        }
+    } else {
+        m_bg_line.fill(0);
     }
-    
-    if (m_lcdc & LCDC_WIN_ENABLE) {
-        RenderWindow(m_scanline);
-    }
-    
+
+    m_obj_line.fill(0);
     if (m_lcdc & LCDC_OBJ_ENABLE) {
         RenderSprites(m_scanline);
     }
+
+    // Merge the layers into the framebuffer
+    u8* line = &m_shades[m_scanline * SCREEN_WIDTH];
+    if (m_lcdc & LCDC_BG_ENABLE) {
+        ComposeScanline(line, m_bg_line.data(), m_obj_line.data(), m_palette, SCREEN_WIDTH);
+    } else {
+        LinePalette palette = m_palette;
+        std::fill_n(palette.begin(), 4, u8{0});
+        ComposeScanline(line, m_bg_line.data(), m_obj_line.data(), palette, SCREEN_WIDTH);
+    }
+    m_framebuffer_stale = true;
 }
 
 void PPU::RenderBackground(u8 scanline) {
-    u8* vram = m_memory.GetVRAM();
+    const u8* vram = m_memory.GetVRAM();
     
     // Determine tile map address
     u16 tile_map_base = (m_lcdc & LCDC_BG_TILE_MAP) ? 0x1C00 : 0x1800;
     
-    // Determine tile data addressing mode
-    bool signed_addressing = (m_lcdc & LCDC_BG_TILE_DATA) == 0;
-    u16 tile_data_base = signed_addressing ? 0x1000 : 0x0000;
-    
     // Calculate Y position with scroll
     u8 y = scanline + m_scy;
-    u8 tile_y = y / 8;
+    const u8* tile_map_row = vram + tile_map_base + (y / 8) * 32;
     u8 pixel_y = y % 8;
-    
-    // Render 160 pixels
-    for (u8 x = 0; x < SCREEN_WIDTH; x++) {
-        // Calculate X position with scroll
-        u8 scroll_x = x + m_scx;
-        u8 tile_x = scroll_x / 8;
-        u8 pixel_x = scroll_x % 8;
-        
-        // Get tile index from tile map
-        u16 tile_map_addr = tile_map_base + (tile_y * 32) + tile_x;
-        u8 tile_index = vram[tile_map_addr];
-        
-        // Calculate tile data address
-        u16 tile_addr;
-        if (signed_addressing) {
-            s8 signed_index = static_cast<s8>(tile_index);
-            tile_addr = tile_data_base + ((signed_index + 128) * 16);
-        } else {
-            tile_addr = tile_data_base + (tile_index * 16);
-        }
-        
-        // Get pixel color (2 bits per pixel)
-        u8 color_id = GetTilePixel(tile_addr, pixel_x, pixel_y);
-        
-        // Apply palette and set pixel
-        u32 color = GetColor(m_bgp, color_id);
-        m_framebuffer[scanline * SCREEN_WIDTH + x] = color;
+
+    // Render 8 pixels per tile; SCX cuts into the first and last tile
+    u8 tile_x = m_scx / 8;
+    for (s32 x = -(m_scx % 8); x < static_cast<s32>(SCREEN_WIDTH); x += 8) {
+        const u16 tile = GetBGTile(tile_map_row[tile_x]);
+        DrawTileRow(m_bg_line.data(), x, GetTileRow(tile, pixel_y));
+        tile_x = (tile_x + 1) % 32;
     }
 }
 
@@ -263,58 +384,34 @@ void PPU::RenderWindow(u8 scanline) {
         return;
     }
     
-    u8* vram = m_memory.GetVRAM();
+    const u8* vram = m_memory.GetVRAM();
     
     // Determine tile map address
     u16 tile_map_base = (m_lcdc & LCDC_WIN_TILE_MAP) ? 0x1C00 : 0x1800;
     
-    // Determine tile data addressing mode
-    bool signed_addressing = (m_lcdc & LCDC_BG_TILE_DATA) == 0;
-    u16 tile_data_base = signed_addressing ? 0x1000 : 0x0000;
-    
     // Window Y coordinate
     u8 window_y = scanline - m_wy;
-    u8 tile_y = window_y / 8;
+    const u8* tile_map_row = vram + tile_map_base + (window_y / 8) * 32;
     u8 pixel_y = window_y % 8;
-    
-    // Render window pixels
-    for (u8 x = 0; x < SCREEN_WIDTH; x++) {
-        // Check if pixel is in window area
-        s16 window_x = x - (m_wx - 7);
-        if (window_x < 0) continue;
-        
-        u8 tile_x = window_x / 8;
-        u8 pixel_x = window_x % 8;
-        
-        // Get tile index from tile map
-        u16 tile_map_addr = tile_map_base + (tile_y * 32) + tile_x;
-        u8 tile_index = vram[tile_map_addr];
-        
-        // Calculate tile data address
-        u16 tile_addr;
-        if (signed_addressing) {
-            s8 signed_index = static_cast<s8>(tile_index);
-            tile_addr = tile_data_base + ((signed_index + 128) * 16);
-        } else {
-            tile_addr = tile_data_base + (tile_index * 16);
-        }
-        
-        // Get pixel color
-        u8 color_id = GetTilePixel(tile_addr, pixel_x, pixel_y);
-        
-        // Apply palette and set pixel
-        u32 color = GetColor(m_bgp, color_id);
-        m_framebuffer[scanline * SCREEN_WIDTH + x] = color;
+
+    // The window starts at WX - 7 and covers the rest of the line
+    const s32 window_start = m_wx - 7;
+    u8 tile_x = 0;
+    for (s32 x = window_start; x < static_cast<s32>(SCREEN_WIDTH); x += 8, tile_x++) {
+        if (x + 8 <= 0) continue;
+
+        const u16 tile = GetBGTile(tile_map_row[tile_x]);
+        DrawTileRow(m_bg_line.data(), x, GetTileRow(tile, pixel_y));
     }
 }
 
 void PPU::RenderSprites(u8 scanline) {
     if (m_sprite_count == 0) return;
     
-    u8* vram = m_memory.GetVRAM();
     u8 sprite_height = (m_lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
     
-    // Render sprites (in reverse order for priority)
+    // Render sprites in reverse order, so the highest priority opaque pixel
+    // ends up in the line; BG priority is resolved by the compositor
     for (s8 i = m_sprite_count - 1; i >= 0; i--) {
         const Sprite& sprite = m_sprite_buffer[i];
         
@@ -333,139 +430,128 @@ void PPU::RenderSprites(u8 scanline) {
             tile_index &= 0xFE;  // Use even tile for 8x16 sprites
         }
         
-        // Calculate tile address
-        u16 tile_addr = tile_index * 16;
+        // Rows of an 8x16 sprite continue into the next tile
+        const TileRow& pixels = m_tile_rows[tile_index * 8 + y_offset];
         
-        // Select palette
-        u8 palette = sprite.palette() ? m_obp1 : m_obp0;
+        // Palette and BG priority travel with each pixel
+        const u8 attributes = (sprite.palette() ? OBJ_PALETTE_1 : 0) |
+                              (sprite.priority() ? 0 : OBJ_BEHIND_BG);
         
         // Render sprite pixels
         for (u8 x = 0; x < 8; x++) {
             s16 screen_x = sprite_x + x;
             
             // Skip if off-screen
-            if (screen_x < 0 || screen_x >= SCREEN_WIDTH) continue;
+            if (screen_x < 0 || screen_x >= static_cast<s16>(SCREEN_WIDTH)) continue;
             
-            u8 pixel_x = sprite.x_flip() ? (7 - x) : x;
-            u8 color_id = GetTilePixel(tile_addr, pixel_x, y_offset);
+            u8 color_id = pixels[sprite.x_flip() ? (7 - x) : x];
             
             // Color 0 is transparent for sprites
             if (color_id == 0) continue;
             
-            // Check priority (if sprite is behind BG)
-            if (!sprite.priority()) {
-                // Get BG color at this position
-                u32 bg_pixel = m_framebuffer[scanline * SCREEN_WIDTH + screen_x];
-                // If BG pixel is not color 0 (white), skip sprite pixel
-                if (bg_pixel != GetColor(m_bgp, 0)) {
-                    continue;
-                }
-            }
-            
-            // Draw sprite pixel
-            u32 color = GetColor(palette, color_id);
-            m_framebuffer[scanline * SCREEN_WIDTH + screen_x] = color;
+            m_obj_line[screen_x] = color_id | attributes;
+        }
+    }
+}
+
+void PPU::UpdateTileCache() {
+    Memory::TileDirtyMask& dirty = m_memory.GetDirtyTiles();
+
+    for (size_t word = 0; word < dirty.size(); word++) {
+        u64 bits = dirty[word];
+        while (bits) {
+            DecodeTile(static_cast<u16>(word * 64 + std::countr_zero(bits)));
+            bits &= bits - 1;
         }
+        dirty[word] = 0;
     }
 }
 
-u8 PPU::GetTilePixel(u16 tile_data_addr, u8 x, u8 y) {
-    u8* vram = m_memory.GetVRAM();
+void PPU::DecodeTile(u16 tile) {
+    const u8* data = m_memory.GetVRAM() + tile * Memory::TILE_SIZE;
     
     // Each tile is 16 bytes (8x8 pixels, 2 bits per pixel)
-    // Each row is 2 bytes
-    u16 addr = tile_data_addr + (y * 2);
-    
-    u8 byte1 = vram[addr];
-    u8 byte2 = vram[addr + 1];
-    
-    // Get the bit for this pixel (MSB = leftmost pixel)
-    u8 bit = 7 - x;
-    u8 color_id = ((byte2 >> bit) & 1) << 1 | ((byte1 >> bit) & 1);
-    
-    return color_id;
+    // Each row is 2 bytes: low bits, then high bits (MSB = leftmost pixel)
+    for (u8 row = 0; row < 8; row++) {
+        const u8 low = data[row * 2];
+        const u8 high = data[row * 2 + 1];
+        TileRow& pixels = m_tile_rows[tile * 8 + row];
+
+        for (u8 x = 0; x < 8; x++) {
+            const u8 bit = 7 - x;
+            pixels[x] = static_cast<u8>(((high >> bit) & 1) << 1 | ((low >> bit) & 1));
+        }
+    }
 }
 
-u32 PPU::GetColor(u8 palette, u8 color_id) {
-    // Extract 2-bit color from palette
-    u8 color = (palette >> (color_id * 2)) & 0x03;
-    
-    // Map to grayscale (DMG palette)
-    // 0 = White, 1 = Light gray, 2 = Dark gray, 3 = Black
-    static const u32 colors[4] = {
-        0xFFFFFFFF,  // White
-        0xFFAAAAAA,  // Light gray
-        0xFF555555,  // Dark gray
-        0xFF000000   // Black
-    };
-    
-    return colors[color];
+u16 PPU::GetBGTile(u8 tile_index) const {
+    // LCDC bit 4 clear: signed indices around 0x9000 (tiles 128-383)
+    if ((m_lcdc & LCDC_BG_TILE_DATA) == 0) {
+        return static_cast<u16>(256 + static_cast<s8>(tile_index));
+    }
+    return tile_index;
+}
+
+void PPU::SetPalette(u8 first, u8 palette) {
+    // Each color id picks a 2-bit shade from the palette
+    for (u8 color_id = 0; color_id < 4; color_id++) {
+        m_palette[first + color_id] = (palette >> (color_id * 2)) & 0x03;
+    }
 }
 
 void PPU::RegisterIOHandlers() {
+    // Only LCDC and the palettes have side effects; everything else is read
+    // and written straight from the PPU's own registers without a call
+
     // LCDC - LCD Control
-    m_memory.RegisterIOHandler(0xFF40,
-        [this](u16) { return m_lcdc; },
-        [this](u16, u8 value) { m_lcdc = value; }
-    );
-    
-    // STAT - LCD Status
-    m_memory.RegisterIOHandler(0xFF41,
-        [this](u16) { return m_stat; },
-        [this](u16, u8 value) { m_stat = (value & 0xF8) | (m_stat & 0x07); }
-    );
-    
-    // SCY - Scroll Y
-    m_memory.RegisterIOHandler(0xFF42,
-        [this](u16) { return m_scy; },
-        [this](u16, u8 value) { m_scy = value; }
-    );
-    
-    // SCX - Scroll X
-    m_memory.RegisterIOHandler(0xFF43,
-        [this](u16) { return m_scx; },
-        [this](u16, u8 value) { m_scx = value; }
-    );
-    
+    m_memory.MapIOHandler<nullptr, &PPU::WriteLCDC>(0xFF40, this, &m_lcdc);
+
+    // STAT - LCD Status (mode and coincidence bits are read-only)
+    m_memory.MapIORegister(0xFF41, &m_stat, 0x00, 0xF8);
+
+    // SCY, SCX - Scroll
+    m_memory.MapIORegister(0xFF42, &m_scy);
+    m_memory.MapIORegister(0xFF43, &m_scx);
+
     // LY - LCD Y (read-only)
-    m_memory.RegisterIOHandler(0xFF44,
-        [this](u16) { return m_scanline; },
-        [](u16, u8) { /* Read-only */ }
-    );
-    
+    m_memory.MapIORegister(0xFF44, &m_scanline, 0x00, 0x00);
+
     // LYC - LY Compare
-    m_memory.RegisterIOHandler(0xFF45,
-        [this](u16) { return m_lyc; },
-        [this](u16, u8 value) { m_lyc = value; }
-    );
-    
-    // BGP - BG Palette
-    m_memory.RegisterIOHandler(0xFF47,
-        [this](u16) { return m_bgp; },
-        [this](u16, u8 value) { m_bgp = value; }
-    );
-    
-    // OBP0 - OBJ Palette 0
-    m_memory.RegisterIOHandler(0xFF48,
-        [this](u16) { return m_obp0; },
-        [this](u16, u8 value) { m_obp0 = value; }
-    );
-    
-    // OBP1 - OBJ Palette 1
-    m_memory.RegisterIOHandler(0xFF49,
-        [this](u16) { return m_obp1; },
-        [this](u16, u8 value) { m_obp1 = value; }
-    );
-    
-    // WY - Window Y
-    m_memory.RegisterIOHandler(0xFF4A,
-        [this](u16) { return m_wy; },
-        [this](u16, u8 value) { m_wy = value; }
-    );
-    
-    // WX - Window X
-    m_memory.RegisterIOHandler(0xFF4B,
-        [this](u16) { return m_wx; },
-        [this](u16, u8 value) { m_wx = value; }
-    );
+    m_memory.MapIORegister(0xFF45, &m_lyc);
+
+    // BGP, OBP0, OBP1 - Palettes
+    m_memory.MapIOHandler<nullptr, &PPU::WriteBGP>(0xFF47, this, &m_bgp);
+    m_memory.MapIOHandler<nullptr, &PPU::WriteOBP0>(0xFF48, this, &m_obp0);
+    m_memory.MapIOHandler<nullptr, &PPU::WriteOBP1>(0xFF49, this, &m_obp1);
+
+    // WY, WX - Window position
+    m_memory.MapIORegister(0xFF4A, &m_wy);
+    m_memory.MapIORegister(0xFF4B, &m_wx);
+}
+
+void PPU::WriteLCDC(u8 value) {
+    const bool was_enabled = (m_lcdc & LCDC_LCD_ENABLE) != 0;
+    m_lcdc = value;
+
+    const bool enabled = (m_lcdc & LCDC_LCD_ENABLE) != 0;
+    if (was_enabled && !enabled) {
+        StopLCD();
+    } else if (!was_enabled && enabled) {
+        StartLCD();
+    }
+}
+
+void PPU::WriteBGP(u8 value) {
+    m_bgp = value;
+    SetPalette(0, value);
+}
+
+void PPU::WriteOBP0(u8 value) {
+    m_obp0 = value;
+    SetPalette(4, value);
+}
+
+void PPU::WriteOBP1(u8 value) {
+    m_obp1 = value;
+    SetPalette(8, value);
 }
@@ -2,6 +2,7 @@
 #include "../types.hpp"
 #include "../memory/memory.hpp"
 #include "../scheduler/scheduler.hpp"
+#include "compositor.hpp"
 #include <array>
 
 class PPU {
@@ -62,39 +63,100 @@ public:
         u8 palette() const { return (flags & 0x10) ? 1 : 0; }  // DMG: 0=OBP0, 1=OBP1
     };
 
+    // How much pixel work to do. Mode timing, STAT/LY, interrupts and OAM
+    // scanning behave the same under every policy.
+    enum class RenderPolicy : u8 {
+        FULL,            // Draw every frame
+        EVERY_N_FRAMES,  // Draw one frame out of every frame_interval
+        TIMING_ONLY      // Never draw; the framebuffer keeps its last contents
+    };
+
     PPU(Memory& memory, Scheduler& scheduler);
     ~PPU() = default;
 
-    // Step PPU by given number of cycles
-    void Step(u32 cycles);
-
     // Reset PPU to power-on state
     void Reset();
 
-    // Get framebuffer (RGBA format)
-    const u32* GetFramebuffer() const { return m_framebuffer.data(); }
+    // The picture as 2-bit shades (0 = white .. 3 = black), one byte per
+    // pixel. This is what the PPU draws; see SHADE_COLORS for the colors.
+    const u8* GetShadeFramebuffer() const { return m_shades.data(); }
+
+    // The picture as ARGB, expanded from the shades on the first call after
+    // they change
+    const u32* GetFramebuffer() const;
+
+    // FULL and TIMING_ONLY apply from the current line on; EVERY_N_FRAMES
+    // starts counting with the next frame
+    void SetRenderPolicy(RenderPolicy policy, u32 frame_interval = 1);
+    RenderPolicy GetRenderPolicy() const { return m_render_policy; }
+    u32 GetFrameInterval() const { return m_frame_interval; }
+
+    // Draw the frame period starting now whatever the policy, e.g. the one
+    // frame of a skipped stretch that is looked at. A full frame period of
+    // drawing covers every visible line wherever it starts. The policy and
+    // its frame count are left alone.
+    void DrawNextFrame();
+
+    // Frames begun since the policy was set (EVERY_N_FRAMES draws those that
+    // are a multiple of the interval); SetRenderPolicy zeroes it, so a
+    // temporary policy switch puts it back afterwards
+    u32 GetFrameCounter() const { return m_frame_counter; }
+    void SetFrameCounter(u32 counter) { m_frame_counter = counter; }
+
+    // Save state: registers, mode, the current line's sprites and the
+    // framebuffer. Render policy is a setting and is kept across restores.
+    struct State {
+        std::array<u8, SCREEN_WIDTH * SCREEN_HEIGHT> shades;
+        std::array<Sprite, 10> sprite_buffer;
+        u8 sprite_count;
+        u8 mode, scanline, frame_ready;
+        u8 lcdc, stat, scy, scx, lyc, bgp, obp0, obp1, wy, wx;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
 
     // Check if frame is ready
     bool IsFrameReady() const { return m_frame_ready; }
     void ClearFrameReady() { m_frame_ready = false; }
 
+#if DMWSS_PERF_COUNTERS
+    const perf::PPUCounters& GetPerfCounters() const { return m_perf; }
+    void ResetPerfCounters() { m_perf = {}; }
+#endif
+
 private:
     Memory& m_memory;
     Scheduler& m_scheduler;
 
-    // PPU state
+    // PPU state (advanced by scheduler events, one per mode transition)
     Mode m_mode;
-    u32 m_cycle_counter;
     u8 m_scanline;          // LY register (0-153)
     bool m_frame_ready;
 
-    // Framebuffer (160x144 pixels, RGBA format)
-    std::array<u32, SCREEN_WIDTH * SCREEN_HEIGHT> m_framebuffer;
+    // Render policy state
+    RenderPolicy m_render_policy;
+    u32 m_frame_interval;
+    u32 m_frame_counter;    // Frames since the policy was set
+    bool m_render_frame;    // Whether the current frame is drawn
+    u64 m_draw_until_cycle; // Frames begun before this are drawn (DrawNextFrame)
+
+    // Framebuffer (160x144 shades) and its ARGB expansion
+    std::array<u8, SCREEN_WIDTH * SCREEN_HEIGHT> m_shades;
+    mutable std::array<u32, SCREEN_WIDTH * SCREEN_HEIGHT> m_framebuffer;
+    mutable bool m_framebuffer_stale;
 
     // Sprite buffer for current scanline
     std::array<Sprite, 10> m_sprite_buffer;  // Max 10 sprites per line
     u8 m_sprite_count;
 
+    // Sprites of every visible line, as the OAM scan picks them (the first 10
+    // in OAM order). Rebuilt when OAM or the OBJ size changes, which for most
+    // games is once per frame, after the DMA.
+    std::array<std::array<Sprite, 10>, SCREEN_HEIGHT> m_line_sprites;
+    std::array<u8, SCREEN_HEIGHT> m_line_sprite_counts;
+    u8 m_sprite_index_height;  // OBJ height the index was built for, 0 = stale
+
     // LCD registers (these are memory-mapped, but we cache them for performance)
     u8 m_lcdc;   // LCD Control (0xFF40)
     u8 m_stat;   // LCD Status (0xFF41)
@@ -107,10 +169,33 @@ private:
     u8 m_wy;     // Window Y (0xFF4A)
     u8 m_wx;     // Window X (0xFF4B)
 
+    // Decoded tile data: one row of 8 color ids (leftmost pixel first) per
+    // tile row, indexed by tile * 8 + row. Refreshed from the memory's dirty
+    // tile mask before each scanline is drawn.
+    using TileRow = std::array<u8, 8>;
+    ALIGN(64) std::array<TileRow, Memory::TILE_COUNT * 8> m_tile_rows;
+
+    // Color-index lines for the current scanline, merged by ComposeScanline
+    ALIGN(16) std::array<u8, SCREEN_WIDTH> m_bg_line;   // BG/window color ids
+    ALIGN(16) std::array<u8, SCREEN_WIDTH> m_obj_line;  // OBJ_* encoded sprite pixels
+
+    // Palette lookups (line index -> shade), rebuilt when BGP/OBP0/OBP1 change
+    LinePalette m_palette;
+
     // Mode switching
     void SetMode(Mode mode);
     void UpdateStatRegister();
 
+    // Scheduler event handlers
+    void EnterOAMScan();
+    void OnLCDTransfer();
+    void OnHBlank();
+    void OnHBlankExit();
+    void OnVBlankLine();
+    void StartLCD();
+    void StopLCD();
+    void BeginFrame();
+
     // Rendering
     void RenderScanline();
     void RenderBackground(u8 scanline);
@@ -119,17 +204,39 @@ private:
 
     // OAM scan
     void ScanOAM();
+    void BuildSpriteIndex(u8 sprite_height);
 
     // Tile/pixel helpers
-    u8 GetTilePixel(u16 tile_data_addr, u8 x, u8 y);
-    u32 GetColor(u8 palette, u8 color_id);
+    void UpdateTileCache();
+    void DecodeTile(u16 tile);
+    const TileRow& GetTileRow(u16 tile, u8 row) const { return m_tile_rows[tile * 8 + row]; }
+    u16 GetBGTile(u8 tile_index) const;
+
+    void SetPalette(u8 first, u8 palette);
+
+    // Copy one tile row with its leftmost pixel at x into a line, clipped to the screen
+    FORCE_INLINE static void DrawTileRow(u8* line, s32 x, const TileRow& pixels) {
+        if (LIKELY(x >= 0 && x + 8 <= static_cast<s32>(SCREEN_WIDTH))) {
+            std::memcpy(line + x, pixels.data(), pixels.size());
+            return;
+        }
+
+        for (u8 i = 0; i < 8; i++) {
+            const s32 screen_x = x + i;
+            if (screen_x >= 0 && screen_x < static_cast<s32>(SCREEN_WIDTH)) {
+                line[screen_x] = pixels[i];
+            }
+        }
+    }
 
     // I/O register handlers
     void RegisterIOHandlers();
-    u8 ReadLCDC();
-    u8 ReadSTAT();
-    u8 ReadLY();
     void WriteLCDC(u8 value);
-    void WriteSTAT(u8 value);
-    void WriteLYC(u8 value);
+    void WriteBGP(u8 value);
+    void WriteOBP0(u8 value);
+    void WriteOBP1(u8 value);
+
+#if DMWSS_PERF_COUNTERS
+    perf::PPUCounters m_perf;
+#endif
 };
@@ -1,91 +1,127 @@
 #include "scheduler.hpp"
-#include <spdlog/spdlog.h>
+#include "../log.hpp"
 
 Scheduler::Scheduler()
-    : m_current_cycle(0) {
+    : m_current_cycle(0)
+    , m_next_event_cycle(NOT_SCHEDULED)
+    , m_next_event_slot(0) {
 }
 
-void Scheduler::Schedule(EventType type, u64 cycles, EventCallback callback) {
-    ScheduledEvent event;
-    event.type = type;
-    event.fire_at_cycle = m_current_cycle + cycles;
-    event.callback = std::move(callback);
+const char* Scheduler::GetEventName(EventType type) {
+    switch (type) {
+        case EventType::VBLANK:              return "vblank";
+        case EventType::HBLANK:              return "hblank";
+        case EventType::HBLANK_EXIT:         return "hblank_exit";
+        case EventType::OAM_SCAN:            return "oam_scan";
+        case EventType::LCD_TRANSFER:        return "lcd_transfer";
+        case EventType::TIMER_OVERFLOW:      return "timer_overflow";
+        case EventType::SERIAL_TRANSFER:     return "serial_transfer";
+        case EventType::APU_CHANNEL_1:       return "apu_channel_1";
+        case EventType::APU_CHANNEL_2:       return "apu_channel_2";
+        case EventType::APU_CHANNEL_3:       return "apu_channel_3";
+        case EventType::APU_CHANNEL_4:       return "apu_channel_4";
+        case EventType::APU_FRAME_SEQUENCER: return "apu_frame_sequencer";
+        case EventType::DMA_TRANSFER:        return "dma_transfer";
+        case EventType::JOYPAD_INTERRUPT:    return "joypad_interrupt";
+    }
+    return "unknown";
+}
+
+void Scheduler::RegisterEvent(EventType type, EventCallback callback, void* context) {
+    EventSlot& slot = m_slots[static_cast<size_t>(type)];
+    slot.callback = callback;
+    slot.context = context;
+}
+
+void Scheduler::Schedule(EventType type, u64 cycles) {
+    const size_t index = static_cast<size_t>(type);
+    EventSlot& slot = m_slots[index];
+    const bool was_next = index == m_next_event_slot;
 
-    m_event_queue.push(event);
+    slot.fire_at_cycle = m_current_cycle + cycles;
 
-    spdlog::trace("Scheduled event type {} to fire at cycle {}",
-                  static_cast<int>(type), event.fire_at_cycle);
+    if (slot.fire_at_cycle < m_next_event_cycle) {
+        m_next_event_cycle = slot.fire_at_cycle;
+        m_next_event_slot = index;
+    } else if (was_next) {
+        // The earliest event moved later; another slot may be due first now
+        UpdateNextEvent();
+    }
+
+    LOG_TRACE("Scheduled event type {} to fire at cycle {}",
+              static_cast<int>(type), slot.fire_at_cycle);
 }
 
 void Scheduler::Deschedule(EventType type) {
-    // Create a new queue without the specified event type
-    std::priority_queue<
-        ScheduledEvent,
-        std::vector<ScheduledEvent>,
-        std::greater<ScheduledEvent>
-    > new_queue;
-
-    // Copy all events except those of the specified type
-    while (!m_event_queue.empty()) {
-        auto event = m_event_queue.top();
-        m_event_queue.pop();
-
-        if (event.type != type) {
-            new_queue.push(event);
-        }
+    const size_t index = static_cast<size_t>(type);
+    m_slots[index].fire_at_cycle = NOT_SCHEDULED;
+
+    if (index == m_next_event_slot) {
+        UpdateNextEvent();
     }
 
-    m_event_queue = std::move(new_queue);
-    spdlog::trace("Descheduled all events of type {}", static_cast<int>(type));
+    LOG_TRACE("Descheduled event type {}", static_cast<int>(type));
 }
 
-void Scheduler::Advance(u64 cycles) {
-    m_current_cycle += cycles;
-}
+void Scheduler::DispatchEvents() {
+    const u64 now = m_current_cycle;
 
-void Scheduler::ProcessEvents() {
-    while (!m_event_queue.empty()) {
-        const auto& next_event = m_event_queue.top();
+    while (m_next_event_cycle <= now) {
+        EventSlot& slot = m_slots[m_next_event_slot];
+        PERF_COUNT(m_perf.events[m_next_event_slot]);
 
-        // Check if this event is ready to fire
-        if (next_event.fire_at_cycle <= m_current_cycle) {
-            spdlog::trace("Processing event type {} at cycle {}",
-                          static_cast<int>(next_event.type), m_current_cycle);
+        LOG_TRACE("Processing event type {} at cycle {}",
+                  m_next_event_slot, slot.fire_at_cycle);
 
-            // Execute the callback
-            next_event.callback();
+        // Run the callback at the event's own timestamp
+        m_current_cycle = slot.fire_at_cycle;
+        TRACE_RECORD(m_trace, TraceEvent::SCHEDULER_EVENT, static_cast<u8>(m_next_event_slot));
+        slot.fire_at_cycle = NOT_SCHEDULED;
+        UpdateNextEvent();
 
-            // Remove the event from the queue
-            m_event_queue.pop();
-        } else {
-            // Events are ordered by fire time, so if this one isn't ready,
-            // no subsequent events will be ready either
-            break;
+        if (slot.callback) {
+            slot.callback(slot.context);
         }
     }
-}
 
-u64 Scheduler::GetCyclesUntilNextEvent() const {
-    if (m_event_queue.empty()) {
-        // Return a large number if no events are scheduled
-        return 0xFFFFFFFFFFFFFFFF;
-    }
+    m_current_cycle = now;
+}
 
-    const auto& next_event = m_event_queue.top();
+void Scheduler::UpdateNextEvent() {
+    m_next_event_cycle = NOT_SCHEDULED;
+    m_next_event_slot = 0;
 
-    if (next_event.fire_at_cycle <= m_current_cycle) {
-        return 0;  // Event is ready now
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; i++) {
+        if (m_slots[i].fire_at_cycle < m_next_event_cycle) {
+            m_next_event_cycle = m_slots[i].fire_at_cycle;
+            m_next_event_slot = i;
+        }
     }
-
-    return next_event.fire_at_cycle - m_current_cycle;
 }
 
 void Scheduler::Reset() {
-    // Clear all events
-    while (!m_event_queue.empty()) {
-        m_event_queue.pop();
+    // Clear all pending events (registered callbacks stay bound)
+    for (EventSlot& slot : m_slots) {
+        slot.fire_at_cycle = NOT_SCHEDULED;
     }
 
     m_current_cycle = 0;
+    m_next_event_cycle = NOT_SCHEDULED;
+    m_next_event_slot = 0;
     spdlog::debug("Scheduler reset");
 }
+
+void Scheduler::SaveState(State& state) const {
+    state.current_cycle = m_current_cycle;
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; i++) {
+        state.fire_at_cycle[i] = m_slots[i].fire_at_cycle;
+    }
+}
+
+void Scheduler::LoadState(const State& state) {
+    m_current_cycle = state.current_cycle;
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; i++) {
+        m_slots[i].fire_at_cycle = state.fire_at_cycle[i];
+    }
+    UpdateNextEvent();
+}
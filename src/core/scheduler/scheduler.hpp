@@ -1,8 +1,8 @@
 #pragma once
 #include "../types.hpp"
-#include <functional>
-#include <queue>
-#include <vector>
+#include "../perf/perf_counters.hpp"
+#include "../debug/trace_ring.hpp"
+#include <array>
 
 class Scheduler {
 public:
@@ -24,51 +24,102 @@ public:
         JOYPAD_INTERRUPT
     };
 
-    // Callback function type
-    using EventCallback = std::function<void()>;
+    static constexpr size_t EVENT_TYPE_COUNT = static_cast<size_t>(EventType::JOYPAD_INTERRUPT) + 1;
+    static_assert(EVENT_TYPE_COUNT <= perf::MAX_EVENT_TYPES);
+
+    // Lower-case name for reports and trace dumps ("vblank", "timer_overflow", ...)
+    static const char* GetEventName(EventType type);
+
+    // Callback function type (plain function pointer + owner context)
+    using EventCallback = void (*)(void* context);
 
     Scheduler();
     ~Scheduler() = default;
 
-    // Schedule an event to fire after 'cycles' cycles from now
-    void Schedule(EventType type, u64 cycles, EventCallback callback);
+    // Bind the handler for an event type (typically once, by the owning component)
+    void RegisterEvent(EventType type, EventCallback callback, void* context);
 
-    // Remove all events of a specific type
+    // Schedule an event to fire after 'cycles' cycles from now. Each type has
+    // a single slot, so this replaces any pending event of the same type.
+    void Schedule(EventType type, u64 cycles);
+
+    // Remove the pending event of a specific type
     void Deschedule(EventType type);
 
+    // Check whether an event of the given type is pending
+    bool IsScheduled(EventType type) const {
+        return m_slots[static_cast<size_t>(type)].fire_at_cycle != NOT_SCHEDULED;
+    }
+
     // Advance the scheduler by 'cycles' cycles
-    void Advance(u64 cycles);
+    void Advance(u64 cycles) { m_current_cycle += cycles; }
 
-    // Process all events that are ready to fire
-    void ProcessEvents();
+    // Process all events that are ready to fire. While a callback runs,
+    // GetCurrentCycle() reports the event's own fire cycle, so events
+    // rescheduled from a callback never drift.
+    void ProcessEvents() {
+        if (LIKELY(m_next_event_cycle > m_current_cycle)) return;
+        DispatchEvents();
+    }
 
     // Get the current cycle count
     u64 GetCurrentCycle() const { return m_current_cycle; }
 
+    // Absolute cycle of the earliest pending event (~0 if none)
+    u64 GetNextEventCycle() const { return m_next_event_cycle; }
+
     // Get cycles until next event (useful for CPU timing)
-    u64 GetCyclesUntilNextEvent() const;
+    u64 GetCyclesUntilNextEvent() const {
+        return m_next_event_cycle > m_current_cycle ? m_next_event_cycle - m_current_cycle : 0;
+    }
 
     // Reset the scheduler
     void Reset();
 
+    // Save state: the clock and every pending event (callbacks stay bound)
+    struct State {
+        u64 current_cycle;
+        std::array<u64, EVENT_TYPE_COUNT> fire_at_cycle;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
+
+#if DMWSS_PERF_COUNTERS
+    const perf::SchedulerCounters& GetPerfCounters() const { return m_perf; }
+    void ResetPerfCounters() { m_perf = {}; }
+#endif
+
+#if DMWSS_TRACE_RING
+    // Record every fired event into ring (nullptr: stop)
+    void SetTraceRing(TraceRing* ring) { m_trace = ring; }
+#endif
+
 private:
-    struct ScheduledEvent {
-        EventType type;
-        u64 fire_at_cycle;  // Absolute cycle when this event fires
-        EventCallback callback;
-
-        // For priority queue ordering (earlier events have higher priority)
-        bool operator>(const ScheduledEvent& other) const {
-            return fire_at_cycle > other.fire_at_cycle;
-        }
+    static constexpr u64 NOT_SCHEDULED = ~0ull;
+
+    struct EventSlot {
+        u64 fire_at_cycle = NOT_SCHEDULED;  // Absolute cycle when this event fires
+        EventCallback callback = nullptr;
+        void* context = nullptr;
     };
 
-    // Priority queue with earliest event at the top
-    std::priority_queue<
-        ScheduledEvent,
-        std::vector<ScheduledEvent>,
-        std::greater<ScheduledEvent>
-    > m_event_queue;
+    std::array<EventSlot, EVENT_TYPE_COUNT> m_slots;
 
     u64 m_current_cycle;
+
+    // Earliest pending event, cached so the hot path is a single compare
+    u64 m_next_event_cycle;
+    size_t m_next_event_slot;
+
+#if DMWSS_PERF_COUNTERS
+    perf::SchedulerCounters m_perf;
+#endif
+
+#if DMWSS_TRACE_RING
+    TraceRing* m_trace = nullptr;
+#endif
+
+    void DispatchEvents();
+    void UpdateNextEvent();
 };
@@ -1,84 +1,129 @@
 #include "timer.hpp"
-#include <spdlog/spdlog.h>
+#include "../log.hpp"
+
+namespace {
+
+// log2 of the timer period in cycles, by TAC bits 0-1:
+// 00: 4096 Hz (1024), 01: 262144 Hz (16), 10: 65536 Hz (64), 11: 16384 Hz (256)
+constexpr u32 TIMER_SHIFTS[4] = {10, 4, 6, 8};
+
+}  // namespace
 
 Timer::Timer(Memory& memory, Scheduler& scheduler)
     : m_memory(memory)
     , m_scheduler(scheduler)
-    , m_div_counter(0)
+    , m_div_reset_cycle(0)
+    , m_tima_sync_cycle(0)
     , m_tima(0)
     , m_tma(0)
-    , m_tac(0)
-    , m_timer_counter(0) {
+    , m_tac(0) {
+
+    m_scheduler.RegisterEvent(Scheduler::EventType::TIMER_OVERFLOW,
+        [](void* timer) {
+            auto* self = static_cast<Timer*>(timer);
+            self->Sync();
+            self->ScheduleOverflow();
+        }, this);
 
     RegisterIOHandlers();
     Reset();
 }
 
 void Timer::Reset() {
-    m_div_counter = 0;
+    m_div_reset_cycle = m_scheduler.GetCurrentCycle();
+    m_tima_sync_cycle = m_div_reset_cycle;
     m_tima = 0;
     m_tma = 0;
     m_tac = 0;
-    m_timer_counter = 0;
+
+    m_scheduler.Deschedule(Scheduler::EventType::TIMER_OVERFLOW);
 
     spdlog::debug("Timer reset");
 }
 
-void Timer::Step(u32 cycles) {
-    UpdateDIV(cycles);
+void Timer::SaveState(State& state) const {
+    state = {};
+    state.div_reset_cycle = m_div_reset_cycle;
+    state.tima_sync_cycle = m_tima_sync_cycle;
+    state.tima = m_tima;
+    state.tma = m_tma;
+    state.tac = m_tac;
+}
 
-    if (IsTimerEnabled()) {
-        UpdateTIMA(cycles);
-    }
+void Timer::LoadState(const State& state) {
+    m_div_reset_cycle = state.div_reset_cycle;
+    m_tima_sync_cycle = state.tima_sync_cycle;
+    m_tima = state.tima;
+    m_tma = state.tma;
+    m_tac = state.tac & 0x07;
 }
 
-void Timer::UpdateDIV(u32 cycles) {
-    // DIV increments at 16384 Hz (CPU clock / 256)
-    // CPU runs at 4194304 Hz, so DIV increments every 256 cycles
-    // The DIV register shows the upper 8 bits of m_div_counter
-    m_div_counter += cycles;
+u32 Timer::GetTimerShift() const {
+    return TIMER_SHIFTS[m_tac & 0x03];
 }
 
-void Timer::UpdateTIMA(u32 cycles) {
-    u32 frequency = GetTimerFrequency();
-    m_timer_counter += cycles;
+bool Timer::GetTimerInput() const {
+    // The signal whose falling edge clocks TIMA: enable AND the selected bit
+    const u64 counter = GetSystemCounter(m_scheduler.GetCurrentCycle());
+    return IsTimerEnabled() && ((counter >> (GetTimerShift() - 1)) & 1) != 0;
+}
 
-    while (m_timer_counter >= frequency) {
-        m_timer_counter -= frequency;
+u8 Timer::ComputeTIMA(u64 cycle, bool& overflowed) const {
+    overflowed = false;
+    if (!IsTimerEnabled()) {
+        return m_tima;
+    }
 
-        m_tima++;
+    // Falling edges between the last sync and `cycle`
+    const u32 shift = GetTimerShift();
+    const u64 ticks = (GetSystemCounter(cycle) >> shift) - (GetSystemCounter(m_tima_sync_cycle) >> shift);
 
-        if (m_tima == 0) {
-            // Timer overflow - reload from TMA and request interrupt
-            m_tima = m_tma;
+    const u64 to_overflow = 0x100 - m_tima;
+    if (ticks < to_overflow) {
+        return static_cast<u8>(m_tima + ticks);
+    }
+
+    // Wrapped (the overflow event normally lands right here, so at most
+    // once); from then on TIMA counts up from TMA
+    overflowed = true;
+    return static_cast<u8>(m_tma + (ticks - to_overflow) % (0x100 - m_tma));
+}
+
+void Timer::Sync() {
+    // Bring TIMA up to the scheduler clock
+    const u64 now = m_scheduler.GetCurrentCycle();
+    bool overflowed;
+    m_tima = ComputeTIMA(now, overflowed);
+    m_tima_sync_cycle = now;
 
-            // Request timer interrupt (bit 2 of IF register)
-            m_memory.RequestInterrupt(0x04);
+    if (overflowed) {
+        // Request timer interrupt (bit 2 of IF register)
+        m_memory.RequestInterrupt(0x04);
 
-            spdlog::debug("Timer overflow, TIMA reloaded from TMA: 0x{:02X}, interrupt requested", m_tma);
-        }
+        LOG_DEBUG("Timer overflow, TIMA reloaded from TMA: 0x{:02X}, interrupt requested", m_tma);
     }
 }
 
-u32 Timer::GetTimerFrequency() const {
-    // Timer frequency based on TAC bits 0-1
-    // 00: 4096 Hz   (1024 cycles)
-    // 01: 262144 Hz (16 cycles)
-    // 10: 65536 Hz  (64 cycles)
-    // 11: 16384 Hz  (256 cycles)
-
-    switch (m_tac & 0x03) {
-        case 0: return 1024;
-        case 1: return 16;
-        case 2: return 64;
-        case 3: return 256;
-        default: return 1024;
+void Timer::IncrementTIMA() {
+    // An extra falling edge outside the counter's own (DIV/TAC writes)
+    if (++m_tima == 0) {
+        m_tima = m_tma;
+        m_memory.RequestInterrupt(0x04);
     }
 }
 
-bool Timer::IsTimerEnabled() const {
-    // Timer is enabled when bit 2 of TAC is set
-    return (m_tac & 0x04) != 0;
+void Timer::ScheduleOverflow() {
+    if (!IsTimerEnabled()) {
+        m_scheduler.Deschedule(Scheduler::EventType::TIMER_OVERFLOW);
+        return;
+    }
+
+    // The falling edge that takes TIMA past 0xFF (called right after Sync)
+    const u32 shift = GetTimerShift();
+    const u64 counter = GetSystemCounter(m_tima_sync_cycle);
+    const u64 overflow_counter = ((counter >> shift) + (0x100 - m_tima)) << shift;
+
+    m_scheduler.Schedule(Scheduler::EventType::TIMER_OVERFLOW, overflow_counter - counter);
 }
 
 void Timer::RegisterIOHandlers() {
@@ -86,52 +131,60 @@ void Timer::RegisterIOHandlers() {
     // as that causes infinite recursion. We store values locally instead.
 
     // DIV - Divider Register (0xFF04)
-    m_memory.RegisterIOHandler(0xFF04,
-        [this](u16) -> u8 {
-            // Return upper 8 bits of the 16-bit counter
-            return static_cast<u8>(m_div_counter >> 8);
-        },
-        [this](u16, u8) {
-            // Writing any value to DIV resets it to 0
-            m_div_counter = 0;
-        }
-    );
+    m_memory.MapIOHandler<&Timer::ReadDIV, &Timer::WriteDIV>(0xFF04, this);
 
     // TIMA - Timer Counter (0xFF05)
-    m_memory.RegisterIOHandler(0xFF05,
-        [this](u16) -> u8 {
-            return m_tima;
-        },
-        [this](u16, u8 value) {
-            m_tima = value;
-            // Writing to TIMA resets the internal counter
-            m_timer_counter = 0;
-        }
-    );
+    m_memory.MapIOHandler<&Timer::ReadTIMA, &Timer::WriteTIMA>(0xFF05, this);
 
     // TMA - Timer Modulo (0xFF06)
-    m_memory.RegisterIOHandler(0xFF06,
-        [this](u16) -> u8 {
-            return m_tma;
-        },
-        [this](u16, u8 value) {
-            m_tma = value;
-        }
-    );
-
-    // TAC - Timer Control (0xFF07)
-    m_memory.RegisterIOHandler(0xFF07,
-        [this](u16) -> u8 {
-            return m_tac | 0xF8;  // Top 5 bits always set
-        },
-        [this](u16, u8 value) {
-            bool was_enabled = IsTimerEnabled();
-            m_tac = value & 0x07;  // Only bottom 3 bits writable
-
-            // If timer state changed, reset the internal counter
-            if (was_enabled != IsTimerEnabled()) {
-                m_timer_counter = 0;
-            }
-        }
-    );
+    m_memory.MapIOHandler<nullptr, &Timer::WriteTMA>(0xFF06, this, &m_tma);
+
+    // TAC - Timer Control (0xFF07), top 5 bits always read as 1
+    m_memory.MapIOHandler<nullptr, &Timer::WriteTAC>(0xFF07, this, &m_tac, 0xF8);
+}
+
+u8 Timer::ReadDIV() {
+    // Upper 8 bits of the 16-bit system counter
+    return static_cast<u8>(GetSystemCounter(m_scheduler.GetCurrentCycle()) >> 8);
+}
+
+void Timer::WriteDIV(u8) {
+    // Writing any value resets the system counter; if the selected bit was
+    // set, that is a falling edge and TIMA ticks
+    Sync();
+    if (GetTimerInput()) {
+        IncrementTIMA();
+    }
+    m_div_reset_cycle = m_tima_sync_cycle;
+    ScheduleOverflow();
+}
+
+u8 Timer::ReadTIMA() {
+    bool overflowed;
+    return ComputeTIMA(m_scheduler.GetCurrentCycle(), overflowed);
+}
+
+void Timer::WriteTIMA(u8 value) {
+    Sync();
+    m_tima = value;
+    ScheduleOverflow();
+}
+
+void Timer::WriteTMA(u8 value) {
+    // The overflow cycle doesn't depend on TMA, only what follows it
+    Sync();
+    m_tma = value;
+}
+
+void Timer::WriteTAC(u8 value) {
+    Sync();
+    const bool was_high = GetTimerInput();
+    m_tac = value & 0x07;  // Only bottom 3 bits writable
+
+    // Disabling the timer or selecting a bit that is clear drops the input
+    // signal: a falling edge like any other (DMG behaviour)
+    if (was_high && !GetTimerInput()) {
+        IncrementTIMA();
+    }
+    ScheduleOverflow();
 }
@@ -9,27 +9,48 @@ public:
     ~Timer() = default;
 
     void Reset();
-    void Step(u32 cycles);
+
+    // Save state (the overflow event itself is saved with the scheduler)
+    struct State {
+        u64 div_reset_cycle;
+        u64 tima_sync_cycle;
+        u8 tima, tma, tac;
+    };
+
+    void SaveState(State& state) const;
+    void LoadState(const State& state);
 
 private:
     Memory& m_memory;
     Scheduler& m_scheduler;
 
-    // Timer registers
-    u16 m_div_counter;      // Internal DIV counter (increments at 16384 Hz)
-    u8 m_tima;              // Timer counter (0xFF05)
+    // Nothing ticks: the 16-bit system counter (DIV is its upper byte) is the
+    // scheduler clock minus the cycle DIV was last reset, and TIMA is derived
+    // from it arithmetically. TIMA increments on every falling edge of the
+    // counter bit selected by TAC, i.e. each time the counter crosses a
+    // multiple of the timer period.
+    u64 m_div_reset_cycle;  // Cycle the system counter was last zero
+    u64 m_tima_sync_cycle;  // Cycle m_tima was last brought up to date
+    u8 m_tima;              // Timer counter (0xFF05) as of m_tima_sync_cycle
     u8 m_tma;               // Timer modulo (0xFF06)
     u8 m_tac;               // Timer control (0xFF07)
 
-    // Timing
-    u32 m_timer_counter;
-
     // Helper methods
-    void UpdateDIV(u32 cycles);
-    void UpdateTIMA(u32 cycles);
-    u32 GetTimerFrequency() const;
-    bool IsTimerEnabled() const;
+    u64 GetSystemCounter(u64 cycle) const { return cycle - m_div_reset_cycle; }
+    u32 GetTimerShift() const;
+    bool IsTimerEnabled() const { return (m_tac & 0x04) != 0; }
+    bool GetTimerInput() const;
+    u8 ComputeTIMA(u64 cycle, bool& overflowed) const;
+    void Sync();
+    void IncrementTIMA();
+    void ScheduleOverflow();
 
     // I/O register handlers
     void RegisterIOHandlers();
+    u8 ReadDIV();
+    void WriteDIV(u8 value);
+    u8 ReadTIMA();
+    void WriteTIMA(u8 value);
+    void WriteTMA(u8 value);
+    void WriteTAC(u8 value);
 };
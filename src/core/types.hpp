@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
 #include <array>
+#include <bit>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -53,3 +55,23 @@ constexpr u8 set_bit(u8 value, u8 bit, bool set) {
 constexpr s16 sign_extend_8(u8 value) {
     return static_cast<s16>(static_cast<s8>(value));
 }
+
+// Unaligned little-endian 16-bit access
+FORCE_INLINE u16 LoadLE16(const u8* data) {
+    if constexpr (std::endian::native == std::endian::little) {
+        u16 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    } else {
+        return static_cast<u16>(data[0] | (data[1] << 8));
+    }
+}
+
+FORCE_INLINE void StoreLE16(u8* data, u16 value) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(data, &value, sizeof(value));
+    } else {
+        data[0] = static_cast<u8>(value & 0xFF);
+        data[1] = static_cast<u8>(value >> 8);
+    }
+}
@@ -0,0 +1,125 @@
+#include "batch_runner.hpp"
+#include "../machine/gameboy.hpp"
+#include "../core/debug/trace_ring.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+// Images stay alive only while some job holds them
+std::mutex s_rom_cache_mutex;
+std::unordered_map<std::string, std::weak_ptr<const ROMImage>> s_rom_cache;
+
+// "<dir>/<index>_<rom stem><extension>"
+std::string OutputPath(const std::string& dir, size_t index, const std::string& rom_path, const char* extension) {
+    const std::string stem = std::filesystem::path(rom_path).stem().string();
+    return (std::filesystem::path(dir) / (std::to_string(index) + "_" + stem + extension)).string();
+}
+
+}  // namespace
+
+BatchResult RunBatchJob(const BatchJob& job, size_t index, const std::string& screenshot_dir,
+                        const std::string& trace_dir) {
+    BatchResult result;
+    result.rom_path = job.rom_path;
+    result.frames = job.frames;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    GameBoy gameboy;
+    if (!gameboy.LoadROM(LoadSharedROM(job.rom_path))) {
+        spdlog::error("Skipping ROM that failed to load: {}", job.rom_path);
+        return result;
+    }
+    result.loaded = true;
+    result.rendered = job.render_policy != PPU::RenderPolicy::TIMING_ONLY;
+
+    gameboy.SetRenderPolicy(job.render_policy, job.render_interval);
+    const bool tracing = !trace_dir.empty() && gameboy.EnableTrace(TRACE_RECORDS);
+
+    for (u32 frame = 0; frame < job.frames; frame++) {
+        // The screenshot and hash need the last frame's pixels
+        if (frame + 1 == job.frames && job.render_policy == PPU::RenderPolicy::EVERY_N_FRAMES) {
+            gameboy.DrawNextFrame();
+        }
+        gameboy.RunFrame();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    result.wall_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    result.cycles = gameboy.GetCycleCount();
+    result.framebuffer_hash = HashFramebuffer(gameboy.GetFramebuffer(), PPU::SCREEN_WIDTH * PPU::SCREEN_HEIGHT);
+    result.perf = gameboy.GetPerfStats();
+
+    if (!screenshot_dir.empty() && result.rendered) {
+        const std::string path = OutputPath(screenshot_dir, index, job.rom_path, ".ppm");
+        if (WritePPM(path, gameboy.GetFramebuffer(), PPU::SCREEN_WIDTH, PPU::SCREEN_HEIGHT)) {
+            result.screenshot_path = path;
+        }
+    }
+
+    if (tracing) {
+        const std::string path = OutputPath(trace_dir, index, job.rom_path, ".trace");
+        if (WriteTraceFile(path, gameboy.GetTraceRing()->GetRecords())) {
+            result.trace_path = path;
+        }
+    }
+
+    return result;
+}
+
+std::shared_ptr<const ROMImage> LoadSharedROM(const std::string& path) {
+    std::lock_guard<std::mutex> lock(s_rom_cache_mutex);
+
+    if (auto image = s_rom_cache[path].lock()) {
+        return image;
+    }
+
+    auto image = ROMImage::FromFile(path);
+    if (image) {
+        s_rom_cache[path] = image;
+    }
+    return image;
+}
+
+u64 HashFramebuffer(const u32* framebuffer, size_t pixel_count) {
+    u64 hash = 0xCBF29CE484222325ull;
+
+    for (size_t i = 0; i < pixel_count; i++) {
+        u32 pixel = framebuffer[i];
+        for (int byte = 0; byte < 4; byte++) {
+            hash ^= pixel & 0xFF;
+            hash *= 0x100000001B3ull;
+            pixel >>= 8;
+        }
+    }
+
+    return hash;
+}
+
+bool WritePPM(const std::string& path, const u32* framebuffer, u32 width, u32 height) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        spdlog::error("Failed to create screenshot: {}", path);
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<u8> row(width * 3);
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++) {
+            const u32 pixel = framebuffer[y * width + x];
+            row[x * 3 + 0] = (pixel >> 16) & 0xFF;
+            row[x * 3 + 1] = (pixel >> 8) & 0xFF;
+            row[x * 3 + 2] = pixel & 0xFF;
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return file.good();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../core/types.hpp"
+#include "../core/ppu/ppu.hpp"
+#include "../core/memory/rom_image.hpp"
+#include "../core/perf/perf_counters.hpp"
+#include <memory>
+#include <string>
+
+// One ROM to run for a fixed number of frames
+struct BatchJob {
+    std::string rom_path;
+    u32 frames;
+    PPU::RenderPolicy render_policy = PPU::RenderPolicy::FULL;
+    u32 render_interval = 1;  // For EVERY_N_FRAMES
+};
+
+struct BatchResult {
+    std::string rom_path;
+    u32 frames = 0;
+    bool loaded = false;
+    bool rendered = false;      // Final frame was drawn (not TIMING_ONLY)
+    u64 framebuffer_hash = 0;   // FNV-1a over the final framebuffer
+    u64 cycles = 0;
+    double wall_ms = 0.0;
+    std::string screenshot_path;  // Empty if no screenshot was written
+    std::string trace_path;       // Empty if no event trace was written
+    PerfStats perf;               // Hot-path counters (DMWSS_PERF_COUNTERS builds)
+};
+
+// Events kept per job when tracing (16 bytes each)
+inline constexpr size_t TRACE_RECORDS = 1 << 16;
+
+// Run a job on a fresh GameBoy instance as fast as possible. If screenshot_dir
+// is not empty, the final framebuffer is written there as a PPM named after
+// the job index and ROM file. With EVERY_N_FRAMES the last frame is always
+// drawn, so hashes and screenshots are comparable to full runs. If trace_dir
+// is not empty (DMWSS_TRACE_RING builds), the last TRACE_RECORDS events go
+// there as a .trace file named the same way.
+BatchResult RunBatchJob(const BatchJob& job, size_t index, const std::string& screenshot_dir,
+                        const std::string& trace_dir);
+
+// Load a ROM image, sharing it with every job currently running the same path
+std::shared_ptr<const ROMImage> LoadSharedROM(const std::string& path);
+
+u64 HashFramebuffer(const u32* framebuffer, size_t pixel_count);
+
+// Write an ARGB framebuffer as binary PPM (P6)
+bool WritePPM(const std::string& path, const u32* framebuffer, u32 width, u32 height);
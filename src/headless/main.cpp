@@ -0,0 +1,298 @@
+#include "batch_runner.hpp"
+#include "work_stealing_pool.hpp"
+#include "perf_report.hpp"
+#include "../core/debug/trace_ring.hpp"
+#include "../core/scheduler/scheduler.hpp"
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr u32 DEFAULT_FRAMES = 600;
+
+struct Options {
+    std::vector<BatchJob> jobs;
+    u32 default_frames = DEFAULT_FRAMES;
+    size_t threads = 0;  // 0 = one per hardware thread
+    std::string screenshot_dir;
+    std::string trace_dir;
+    std::string decode_trace_path;  // Set: decode this trace and exit
+    std::string output_path;  // Empty = stdout
+    PPU::RenderPolicy render_policy = PPU::RenderPolicy::FULL;
+    u32 render_interval = 1;
+    bool verbose = false;
+};
+
+void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options] <rom[:frames]>...\n"
+        "       %s --decode-trace FILE\n"
+        "\n"
+        "Runs every ROM on its own GameBoy instance at uncapped speed and\n"
+        "prints framebuffer hashes and timing stats as JSON. Builds with\n"
+        "DMWSS_PERF_COUNTERS=ON add a per-ROM \"perf\" profile.\n"
+        "\n"
+        "Options:\n"
+        "  -f, --frames N         Frames per ROM without an explicit count (default %u)\n"
+        "  -j, --jobs N           Worker threads (default: hardware threads)\n"
+        "  -l, --list FILE        Read \"<rom> [frames]\" lines from FILE\n"
+        "  -s, --screenshots DIR  Write each final framebuffer as PPM into DIR\n"
+        "  -t, --trace DIR        Write each ROM's last events as a .trace into DIR\n"
+        "                         (DMWSS_TRACE_RING builds)\n"
+        "      --decode-trace FILE  Print a .trace file as text\n"
+        "  -o, --output FILE      Write the JSON report to FILE instead of stdout\n"
+        "  -r, --render MODE      full, none (timing only) or N (draw every Nth frame)\n"
+        "  -v, --verbose          Enable emulator logging\n"
+        "  -h, --help             Show this help\n",
+        program, program, DEFAULT_FRAMES);
+}
+
+// Decimal digits only; values that don't fit a u32 are rejected
+bool ParseCount(const std::string& text, u32& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+// Frame count 0 means "use the default"; resolved after all options are parsed
+BatchJob ParseJob(const std::string& arg) {
+    const size_t colon = arg.rfind(':');
+    u32 frames = 0;
+
+    if (colon != std::string::npos && ParseCount(arg.substr(colon + 1), frames)) {
+        return {arg.substr(0, colon), frames};
+    }
+    return {arg, 0};
+}
+
+bool ParseRenderPolicy(const std::string& text, Options& options) {
+    if (text == "full") {
+        options.render_policy = PPU::RenderPolicy::FULL;
+    } else if (text == "none") {
+        options.render_policy = PPU::RenderPolicy::TIMING_ONLY;
+    } else if (ParseCount(text, options.render_interval) && options.render_interval > 0) {
+        options.render_policy = PPU::RenderPolicy::EVERY_N_FRAMES;
+    } else {
+        spdlog::error("Invalid render mode: {}", text);
+        return false;
+    }
+    return true;
+}
+
+bool ReadJobList(const std::string& path, std::vector<BatchJob>& jobs) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        spdlog::error("Failed to open ROM list: {}", path);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream stream(line);
+        std::string rom;
+        std::string count;
+        stream >> rom >> count;
+        if (rom.empty()) continue;
+
+        u32 frames = 0;
+        if (!count.empty() && !ParseCount(count, frames)) {
+            spdlog::error("Invalid frame count in {}: {}", path, line);
+            return false;
+        }
+        jobs.push_back({rom, frames});
+    }
+
+    return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if ((arg == "-f" || arg == "--frames") && has_value) {
+            if (!ParseCount(argv[++i], options.default_frames)) return false;
+        } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+            u32 threads = 0;
+            if (!ParseCount(argv[++i], threads)) return false;
+            options.threads = threads;
+        } else if ((arg == "-l" || arg == "--list") && has_value) {
+            if (!ReadJobList(argv[++i], options.jobs)) return false;
+        } else if ((arg == "-s" || arg == "--screenshots") && has_value) {
+            options.screenshot_dir = argv[++i];
+        } else if ((arg == "-t" || arg == "--trace") && has_value) {
+            options.trace_dir = argv[++i];
+        } else if (arg == "--decode-trace" && has_value) {
+            options.decode_trace_path = argv[++i];
+        } else if ((arg == "-o" || arg == "--output") && has_value) {
+            options.output_path = argv[++i];
+        } else if ((arg == "-r" || arg == "--render") && has_value) {
+            if (!ParseRenderPolicy(argv[++i], options)) return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            spdlog::error("Unknown or incomplete option: {}", arg);
+            return false;
+        } else {
+            options.jobs.push_back(ParseJob(arg));
+        }
+    }
+
+    for (BatchJob& job : options.jobs) {
+        if (job.frames == 0) {
+            job.frames = options.default_frames;
+        }
+        job.render_policy = options.render_policy;
+        job.render_interval = options.render_interval;
+    }
+
+    return !options.jobs.empty() || !options.decode_trace_path.empty();
+}
+
+std::string FormatHash(u64 hash) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+// One line per record: cycle, PC, event and its data
+int DecodeTrace(const std::string& path) {
+    std::vector<TraceRecord> records;
+    if (!ReadTraceFile(path, records)) {
+        return 1;
+    }
+
+    for (const TraceRecord& record : records) {
+        const TraceEvent event = static_cast<TraceEvent>(record.event);
+        std::printf("%12llu  %04X  %-16s", static_cast<unsigned long long>(record.cycle),
+                    record.pc, TraceEventName(event));
+
+        if (event == TraceEvent::SCHEDULER_EVENT && record.data < Scheduler::EVENT_TYPE_COUNT) {
+            std::printf("%s\n", Scheduler::GetEventName(static_cast<Scheduler::EventType>(record.data)));
+        } else {
+            std::printf("%02X\n", record.data);
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.verbose) {
+        spdlog::set_level(spdlog::level::info);
+    }
+
+    if (!options.decode_trace_path.empty()) {
+        return DecodeTrace(options.decode_trace_path);
+    }
+
+    for (const std::string* dir : {&options.screenshot_dir, &options.trace_dir}) {
+        if (dir->empty()) continue;
+
+        std::error_code error;
+        std::filesystem::create_directories(*dir, error);
+        if (error) {
+            spdlog::error("Failed to create output directory {}: {}", *dir, error.message());
+            return 1;
+        }
+    }
+
+    const size_t threads = options.threads ? options.threads
+                                           : std::max(1u, std::thread::hardware_concurrency());
+
+    // Each job writes only its own slot, so results need no locking
+    std::vector<BatchResult> results(options.jobs.size());
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(threads);
+        for (size_t i = 0; i < options.jobs.size(); i++) {
+            pool.Submit([&, i] {
+                results[i] = RunBatchJob(options.jobs[i], i, options.screenshot_dir, options.trace_dir);
+            });
+        }
+        pool.Wait();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double wall_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    u64 total_frames = 0;
+    bool all_loaded = true;
+
+    nlohmann::json report_results = nlohmann::json::array();
+    for (const BatchResult& result : results) {
+        nlohmann::json entry = {
+            {"rom", result.rom_path},
+            {"frames", result.frames},
+            {"loaded", result.loaded},
+        };
+
+        if (result.loaded) {
+            total_frames += result.frames;
+            if (result.rendered) {
+                entry["framebuffer_hash"] = FormatHash(result.framebuffer_hash);
+            }
+            entry["cycles"] = result.cycles;
+            entry["wall_ms"] = result.wall_ms;
+            entry["fps"] = result.wall_ms > 0.0 ? result.frames * 1000.0 / result.wall_ms : 0.0;
+            if (!result.screenshot_path.empty()) {
+                entry["screenshot"] = result.screenshot_path;
+            }
+            if (!result.trace_path.empty()) {
+                entry["trace"] = result.trace_path;
+            }
+            if (result.perf.enabled) {
+                entry["perf"] = PerfStatsToJSON(result.perf);
+            }
+        } else {
+            all_loaded = false;
+        }
+
+        report_results.push_back(std::move(entry));
+    }
+
+    const nlohmann::json report = {
+        {"threads", threads},
+        {"roms", results.size()},
+        {"total_frames", total_frames},
+        {"wall_ms", wall_ms},
+        {"aggregate_fps", wall_ms > 0.0 ? total_frames * 1000.0 / wall_ms : 0.0},
+        {"results", report_results},
+    };
+
+    if (options.output_path.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream file(options.output_path);
+        if (!file.is_open()) {
+            spdlog::error("Failed to write report: {}", options.output_path);
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+    }
+
+    return all_loaded ? 0 : 1;
+}
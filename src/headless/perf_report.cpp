@@ -0,0 +1,83 @@
+#include "perf_report.hpp"
+#include "../core/scheduler/scheduler.hpp"
+#include <fmt/format.h>
+
+namespace {
+
+nlohmann::json OpcodesToJSON(const std::array<u64, 256>& counts) {
+    nlohmann::json result = nlohmann::json::object();
+    for (size_t opcode = 0; opcode < counts.size(); opcode++) {
+        if (counts[opcode] != 0) {
+            result[fmt::format("{:02X}", opcode)] = counts[opcode];
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+nlohmann::json PerfStatsToJSON(const PerfStats& stats) {
+    const perf::CPUCounters& cpu = stats.cpu;
+    const perf::MemoryCounters& memory = stats.memory;
+
+    u64 instructions = 0;
+    for (u64 count : cpu.opcodes) {
+        instructions += count;
+    }
+
+    nlohmann::json regions = nlohmann::json::object();
+    for (size_t i = 0; i < perf::REGION_COUNT; i++) {
+        const u64 total = memory.fast_reads[i] + memory.slow_reads[i] +
+                          memory.fast_writes[i] + memory.slow_writes[i];
+        if (total == 0) continue;
+
+        regions[perf::RegionName(static_cast<perf::Region>(i))] = {
+            {"fast_reads", memory.fast_reads[i]},
+            {"slow_reads", memory.slow_reads[i]},
+            {"fast_writes", memory.fast_writes[i]},
+            {"slow_writes", memory.slow_writes[i]},
+        };
+    }
+
+    nlohmann::json io = nlohmann::json::object();
+    for (size_t i = 0; i < memory.io_reads.size(); i++) {
+        if (memory.io_reads[i] == 0 && memory.io_writes[i] == 0) continue;
+
+        io[fmt::format("FF{:02X}", i)] = {
+            {"reads", memory.io_reads[i]},
+            {"writes", memory.io_writes[i]},
+        };
+    }
+
+    nlohmann::json events = nlohmann::json::object();
+    for (size_t i = 0; i < Scheduler::EVENT_TYPE_COUNT; i++) {
+        if (stats.scheduler.events[i] != 0) {
+            events[Scheduler::GetEventName(static_cast<Scheduler::EventType>(i))] = stats.scheduler.events[i];
+        }
+    }
+
+    const perf::TimeCounter& render = stats.ppu.render_scanline;
+
+    return {
+        {"cpu", {
+            {"instructions", instructions},
+            {"blocks", cpu.blocks},
+            {"block_compiles", cpu.block_compiles},
+            {"uncached_instructions", cpu.uncached_instructions},
+            {"opcodes", OpcodesToJSON(cpu.opcodes)},
+            {"cb_opcodes", OpcodesToJSON(cpu.cb_opcodes)},
+        }},
+        {"memory", {
+            {"regions", regions},
+            {"io", io},
+        }},
+        {"events", events},
+        {"ppu", {
+            {"render_scanline", {
+                {"calls", render.calls},
+                {"total_ms", render.nanoseconds / 1e6},
+                {"ns_per_call", render.calls ? static_cast<double>(render.nanoseconds) / render.calls : 0.0},
+            }},
+        }},
+    };
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include "../core/perf/perf_counters.hpp"
+#include <nlohmann/json.hpp>
+
+// Profiling report for GameBoy::GetPerfStats(). Zero counters are left out,
+// so opcodes, regions and registers a ROM never touches don't pad the dump.
+nlohmann::json PerfStatsToJSON(const PerfStats& stats);
@@ -0,0 +1,112 @@
+#include "work_stealing_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : m_queued(0)
+    , m_pending(0)
+    , m_next_queue(0)
+    , m_stopping(false) {
+
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+
+    for (size_t i = 0; i < thread_count; i++) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (size_t i = 0; i < thread_count; i++) {
+        m_threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_available.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        WorkerQueue& queue = *m_queues[m_next_queue];
+        m_next_queue = (m_next_queue + 1) % m_queues.size();
+
+        {
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        m_queued++;
+        m_pending++;
+    }
+
+    m_work_available.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_all_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+void WorkStealingPool::WorkerLoop(size_t index) {
+    for (;;) {
+        Task task;
+
+        if (PopTask(index, task)) {
+            task();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) {
+                m_all_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_work_available.wait(lock, [this] { return m_stopping || m_queued > 0; });
+
+        if (m_stopping && m_queued == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::PopTask(size_t index, Task& task) {
+    const size_t count = m_queues.size();
+
+    // Own deque first (newest task), then steal the oldest task of the others
+    for (size_t i = 0; i < count; i++) {
+        WorkerQueue& queue = *m_queues[(index + i) % count];
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        break;
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued--;
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "../core/types.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool where every worker owns a task deque. Workers take
+// their own tasks from the back and steal from the front of other workers'
+// deques once theirs run dry, so uneven jobs (ROMs with very different frame
+// counts) still keep every core busy.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t thread_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queue a task (distributed round-robin over the workers)
+    void Submit(Task task);
+
+    // Block until every submitted task has finished
+    void Wait();
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // Guards the counters below; held while pushing so a pop never outruns its count
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::condition_variable m_all_done;
+    size_t m_queued;    // Tasks sitting in a deque
+    size_t m_pending;   // Tasks submitted but not finished
+    size_t m_next_queue;
+    bool m_stopping;
+
+    void WorkerLoop(size_t index);
+    bool PopTask(size_t index, Task& task);
+};
@@ -1,11 +1,13 @@
 #include "gameboy.hpp"
+#include "snapshot.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 
 GameBoy::GameBoy()
     : m_running(false)
-    , m_total_cycles(0)
-    , m_joypad_state(0xFF) {
+    , m_total_cycles(0) {
 
     // Create components in dependency order
     m_scheduler = std::make_unique<Scheduler>();
@@ -13,6 +15,9 @@ GameBoy::GameBoy()
     m_cpu = std::make_unique<CPU>(*m_memory, *m_scheduler);
     m_ppu = std::make_unique<PPU>(*m_memory, *m_scheduler);
     m_timer = std::make_unique<Timer>(*m_memory, *m_scheduler);
+    m_apu = std::make_unique<APU>(*m_memory, *m_scheduler);
+    m_dma = std::make_unique<DMA>(*m_memory, *m_scheduler);
+    m_joypad = std::make_unique<Joypad>(*m_memory);
 
     RegisterIOHandlers();
 
@@ -21,62 +26,79 @@ GameBoy::GameBoy()
 
 bool GameBoy::LoadROM(const std::string& path) {
     spdlog::info("Loading ROM: {}", path);
+    return LoadROM(ROMImage::FromFile(path));
+}
 
-    // Read ROM file
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        spdlog::error("Failed to open ROM file: {}", path);
-        return false;
-    }
+bool GameBoy::LoadROM(const std::vector<u8>& rom_data) {
+    return LoadROM(ROMImage::FromData(rom_data));
+}
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+bool GameBoy::LoadROM(std::vector<u8>&& rom_data) {
+    return LoadROM(ROMImage::FromData(std::move(rom_data)));
+}
 
-    m_rom_data.resize(size);
-    if (!file.read(reinterpret_cast<char*>(m_rom_data.data()), size)) {
-        spdlog::error("Failed to read ROM file: {}", path);
+bool GameBoy::LoadROM(std::shared_ptr<const ROMImage> rom) {
+    if (!rom) {
         return false;
     }
 
-    return LoadROM(m_rom_data);
-}
+    const ROMImage::Header& header = rom->GetHeader();
+    if (!header.title.empty()) {
+        spdlog::info("ROM Title: {}", header.title);
+    }
+    spdlog::info("Cartridge Type: 0x{:02X}", header.cartridge_type);
+    spdlog::info("ROM Size: {} KB", (32 << header.rom_size_code));
+    spdlog::info("RAM Size: 0x{:02X}", header.ram_size_code);
 
-bool GameBoy::LoadROM(const std::vector<u8>& rom_data) {
-    if (rom_data.size() < 0x150) {
-        spdlog::error("ROM too small (< 0x150 bytes)");
+    // Load ROM into memory
+    if (!m_memory->LoadROM(rom)) {
+        spdlog::error("Failed to load ROM into memory");
         return false;
     }
 
-    m_rom_data = rom_data;
+    m_rom = std::move(rom);
 
-    // Parse ROM header
-    std::string title;
-    for (int i = 0; i < 16; i++) {
-        char c = m_rom_data[0x134 + i];
-        if (c == 0) break;  // Null terminator
-        title += c;
+    if (m_rewind) {
+        m_rewind->Clear();
     }
 
-    u8 cartridge_type = m_rom_data[0x147];
-    u8 rom_size = m_rom_data[0x148];
-    u8 ram_size = m_rom_data[0x149];
+    Reset();
+    m_running = true;
 
-    if (!title.empty()) {
-        spdlog::info("ROM Title: {}", title);
+    return true;
+}
+
+std::unique_ptr<GameBoy> GameBoy::Fork() const {
+    auto child = std::make_unique<GameBoy>();
+    if (!ForkInto(*child)) {
+        return nullptr;
     }
-    spdlog::info("Cartridge Type: 0x{:02X}", cartridge_type);
-    spdlog::info("ROM Size: {} KB", (32 << rom_size));
-    spdlog::info("RAM Size: 0x{:02X}", ram_size);
+    return child;
+}
 
-    // Load ROM into memory
-    if (!m_memory->LoadROM(m_rom_data.data(), m_rom_data.size())) {
-        spdlog::error("Failed to load ROM into memory");
+bool GameBoy::ForkInto(GameBoy& child) const {
+    if (!m_rom) {
+        spdlog::error("Cannot fork an instance without a ROM");
         return false;
     }
 
-    Reset();
-    m_running = true;
+    // Attach the shared image; blocks cached for another ROM are stale
+    if (child.m_rom != m_rom) {
+        if (!child.m_memory->LoadROM(m_rom)) {
+            return false;
+        }
+        child.m_rom = m_rom;
+        child.m_cpu->FlushBlockCache();
+    }
+
+    // The snapshot path copies every component; reuse one buffer per thread
+    thread_local std::vector<u8> snapshot;
+    SaveState(snapshot);
+    if (!child.LoadState(snapshot)) {
+        return false;
+    }
 
+    child.m_running = m_running;
     return true;
 }
 
@@ -84,13 +106,15 @@ void GameBoy::Reset() {
     spdlog::info("Resetting GameBoy");
 
     m_total_cycles = 0;
-    m_joypad_state = 0xFF;
 
     m_scheduler->Reset();
     m_memory->Reset();
     m_cpu->Reset();
     m_ppu->Reset();
     m_timer->Reset();
+    m_apu->Reset();
+    m_dma->Reset();
+    m_joypad->Reset();
 
     m_running = true;
 }
@@ -98,39 +122,263 @@ void GameBoy::Reset() {
 void GameBoy::Step() {
     if (!m_running) return;
 
-    // Execute one CPU instruction
+    // Execute one CPU block (it advances the scheduler clock)
     u32 cycles = m_cpu->Step();
 
-    // Update PPU and Timer
-    m_ppu->Step(cycles);
-    m_timer->Step(cycles);
-
-    // Advance scheduler
-    m_scheduler->Advance(cycles);
+    // PPU, Timer, APU and DMA run from the scheduler's events
     m_scheduler->ProcessEvents();
 
     m_total_cycles += cycles;
 }
 
 void GameBoy::RunFrame() {
-    if (!m_running) return;
+    RunCycles(CYCLES_PER_FRAME);
+
+    if (m_rewind && m_running && ++m_rewind_counter >= m_rewind_interval) {
+        m_rewind_counter = 0;
+        SaveState(m_rewind_snapshot);
+        m_rewind->Push(m_rewind_snapshot);
+    }
+}
+
+const u8* GameBoy::RunFrameAhead(u32 frames) {
+    if (frames == 0 || !m_running) {
+        RunFrame();
+        return GetShadeFramebuffer();
+    }
+
+    const PPU::RenderPolicy policy = m_ppu->GetRenderPolicy();
+    const u32 frame_interval = m_ppu->GetFrameInterval();
+    const u32 frame_counter = m_ppu->GetFrameCounter();
 
-    u32 frame_cycles = 0;
+    // The real frame is never shown, so it needs no pixels; it still records
+    // rewind points and counts toward EVERY_N_FRAMES
+    m_ppu->SetRenderPolicy(PPU::RenderPolicy::TIMING_ONLY);
+    RunFrame();
+    const u32 frames_begun = m_ppu->GetFrameCounter();
 
-    // Run until we've completed a full frame worth of cycles
-    while (frame_cycles < CYCLES_PER_FRAME) {
-        u32 cycles = m_cpu->Step();
+    // Speculative audio is never played. Muting first syncs the APU, so the
+    // snapshot matches what it has already synthesized and unmuting right
+    // after the rollback continues the real frame's stream without a gap.
+    m_apu->SetMuted(true);
+    SaveState(m_run_ahead_snapshot);
+
+    for (u32 frame = 1; frame < frames; frame++) {
+        RunCycles(CYCLES_PER_FRAME);
+    }
 
-        m_ppu->Step(cycles);
-        m_timer->Step(cycles);
-        m_scheduler->Advance(cycles);
+    DrawNextFrame();
+    RunCycles(CYCLES_PER_FRAME);
+    std::memcpy(m_run_ahead_shades.data(), GetShadeFramebuffer(), sizeof(m_run_ahead_shades));
+
+    LoadState(m_run_ahead_snapshot);
+    m_apu->SetMuted(false);
+    m_ppu->SetRenderPolicy(policy, frame_interval);
+    m_ppu->SetFrameCounter(frame_counter + frames_begun);
+
+    return m_run_ahead_shades.data();
+}
+
+void GameBoy::EnableRewind(size_t max_bytes, u32 frame_interval, u32 keyframe_interval) {
+    m_rewind = std::make_unique<RewindBuffer>(max_bytes, keyframe_interval);
+    m_rewind_interval = std::max<u32>(frame_interval, 1);
+    m_rewind_counter = 0;
+}
+
+void GameBoy::DisableRewind() {
+    m_rewind.reset();
+    m_rewind_snapshot = {};
+}
+
+PerfStats GameBoy::GetPerfStats() const {
+    PerfStats stats;
+#if DMWSS_PERF_COUNTERS
+    stats.cpu = m_cpu->GetPerfCounters();
+    stats.memory = m_memory->GetPerfCounters();
+    stats.scheduler = m_scheduler->GetPerfCounters();
+    stats.ppu = m_ppu->GetPerfCounters();
+#endif
+    return stats;
+}
+
+void GameBoy::ResetPerfStats() {
+#if DMWSS_PERF_COUNTERS
+    m_cpu->ResetPerfCounters();
+    m_memory->ResetPerfCounters();
+    m_scheduler->ResetPerfCounters();
+    m_ppu->ResetPerfCounters();
+#endif
+}
+
+bool GameBoy::EnableTrace(size_t records) {
+#if DMWSS_TRACE_RING
+    m_trace = std::make_unique<TraceRing>(*m_scheduler, *m_cpu, records);
+    m_scheduler->SetTraceRing(m_trace.get());
+    m_cpu->SetTraceRing(m_trace.get());
+    m_memory->SetTraceRing(m_trace.get());
+    return true;
+#else
+    (void)records;
+    spdlog::warn("Event tracing is not compiled in (configure with -DDMWSS_TRACE_RING=ON)");
+    return false;
+#endif
+}
+
+void GameBoy::DisableTrace() {
+#if DMWSS_TRACE_RING
+    m_scheduler->SetTraceRing(nullptr);
+    m_cpu->SetTraceRing(nullptr);
+    m_memory->SetTraceRing(nullptr);
+#endif
+    m_trace.reset();
+}
+
+bool GameBoy::Rewind() {
+    if (!m_rewind || !m_rewind->Pop(m_rewind_snapshot)) {
+        return false;
+    }
+
+    m_rewind_counter = 0;
+    return LoadState(m_rewind_snapshot);
+}
+
+void GameBoy::RunCycles(u64 cycles) {
+    if (!m_running) return;
+
+    const u64 start = m_scheduler->GetCurrentCycle();
+    const u64 target = start + cycles;
+
+    // Let the CPU run uninterrupted up to the next scheduler deadline, then fire
+    // the events that are due
+    while (m_scheduler->GetCurrentCycle() < target) {
+        m_cpu->RunUntil(target);
         m_scheduler->ProcessEvents();
+    }
 
-        frame_cycles += cycles;
-        m_total_cycles += cycles;
+    m_total_cycles += m_scheduler->GetCurrentCycle() - start;
+}
+
+void GameBoy::FillSnapshotHeader(SnapshotHeader& header) const {
+    header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.header_size = sizeof(SnapshotHeader);
+    header.state_size = sizeof(MachineState);
+    header.ram_size = static_cast<u32>(m_memory->GetCartridgeRAMSize());
+
+    if (m_rom) {
+        header.rom_size = static_cast<u32>(m_rom->GetSize());
+        header.rom_checksum = m_rom->GetHeader().global_checksum;
+        header.cartridge_type = m_rom->GetHeader().cartridge_type;
     }
 }
 
+void GameBoy::SaveState(std::vector<u8>& snapshot) const {
+    SnapshotHeader header;
+    FillSnapshotHeader(header);
+
+    snapshot.resize(SNAPSHOT_RAM_OFFSET + header.ram_size);
+    std::memcpy(snapshot.data(), &header, sizeof(header));
+
+    // Components write straight into the buffer
+    MachineState& state = *reinterpret_cast<MachineState*>(snapshot.data() + SNAPSHOT_STATE_OFFSET);
+    m_scheduler->SaveState(state.scheduler);
+    m_cpu->SaveState(state.cpu);
+    m_memory->SaveState(state.memory);
+    m_ppu->SaveState(state.ppu);
+    m_timer->SaveState(state.timer);
+    m_apu->SaveState(state.apu);
+    m_dma->SaveState(state.dma);
+    m_joypad->SaveState(state.joypad);
+    state.total_cycles = m_total_cycles;
+
+    if (header.ram_size > 0) {
+        std::memcpy(snapshot.data() + SNAPSHOT_RAM_OFFSET, m_memory->GetCartridgeRAM(), header.ram_size);
+    }
+}
+
+bool GameBoy::LoadState(const std::vector<u8>& snapshot) {
+    if (snapshot.size() < sizeof(SnapshotHeader)) {
+        spdlog::error("Snapshot too small ({} bytes)", snapshot.size());
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, snapshot.data(), sizeof(header));
+
+    if (header.magic != SNAPSHOT_MAGIC) {
+        spdlog::error("Not a snapshot (bad magic 0x{:08X})", header.magic);
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION || header.header_size != sizeof(SnapshotHeader) ||
+        header.state_size != sizeof(MachineState)) {
+        spdlog::error("Unsupported snapshot version {} (expected {})", header.version, SNAPSHOT_VERSION);
+        return false;
+    }
+
+    SnapshotHeader expected;
+    FillSnapshotHeader(expected);
+    if (header.rom_size != expected.rom_size || header.rom_checksum != expected.rom_checksum ||
+        header.cartridge_type != expected.cartridge_type || header.ram_size != expected.ram_size) {
+        spdlog::error("Snapshot was taken with a different ROM");
+        return false;
+    }
+
+    if (snapshot.size() != SNAPSHOT_RAM_OFFSET + header.ram_size) {
+        spdlog::error("Snapshot size mismatch: {} bytes, expected {}",
+                      snapshot.size(), SNAPSHOT_RAM_OFFSET + header.ram_size);
+        return false;
+    }
+
+    const MachineState& state = *reinterpret_cast<const MachineState*>(snapshot.data() + SNAPSHOT_STATE_OFFSET);
+    m_scheduler->LoadState(state.scheduler);
+    m_memory->LoadState(state.memory);
+    m_cpu->LoadState(state.cpu);
+    m_ppu->LoadState(state.ppu);
+    m_timer->LoadState(state.timer);
+    m_apu->LoadState(state.apu);
+    m_dma->LoadState(state.dma);
+    m_joypad->LoadState(state.joypad);
+    m_total_cycles = state.total_cycles;
+
+    if (header.ram_size > 0) {
+        std::memcpy(m_memory->GetCartridgeRAM(), snapshot.data() + SNAPSHOT_RAM_OFFSET, header.ram_size);
+    }
+
+    return true;
+}
+
+bool GameBoy::SaveStateToFile(const std::string& path) const {
+    std::vector<u8> snapshot;
+    SaveState(snapshot);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        spdlog::error("Failed to create snapshot file: {}", path);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(snapshot.data()), snapshot.size());
+    return file.good();
+}
+
+bool GameBoy::LoadStateFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        spdlog::error("Failed to open snapshot file: {}", path);
+        return false;
+    }
+
+    std::vector<u8> snapshot(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(snapshot.data()), snapshot.size())) {
+        spdlog::error("Failed to read snapshot file: {}", path);
+        return false;
+    }
+
+    return LoadState(snapshot);
+}
+
 void GameBoy::RegisterIOHandlers() {
     // Note: I/O handlers should NOT call m_memory->Read/Write for I/O addresses
     // as that would cause infinite recursion. The Memory class handles storing
@@ -5,39 +5,117 @@
 #include "../core/cpu/cpu.hpp"
 #include "../core/ppu/ppu.hpp"
 #include "../core/timer/timer.hpp"
+#include "../core/apu/apu.hpp"
+#include "../core/dma/dma.hpp"
+#include "../core/joypad/joypad.hpp"
+#include "rewind.hpp"
 #include <string>
 #include <vector>
 #include <memory>
 
 class GameBoy {
 public:
+    // Timing
+    static constexpr u32 CLOCK_RATE = 4194304;
+    static constexpr u32 CYCLES_PER_FRAME = 70224;  // ~59.73 Hz
+
     GameBoy();
     ~GameBoy() = default;
 
-    // ROM loading
+    // ROM loading. Instances loading the same image share it. Files are
+    // memory-mapped where possible; byte vectors are moved (or copied) into a
+    // new image.
+    bool LoadROM(std::shared_ptr<const ROMImage> rom);
     bool LoadROM(const std::string& path);
     bool LoadROM(const std::vector<u8>& rom_data);
+    bool LoadROM(std::vector<u8>&& rom_data);
+    const std::shared_ptr<const ROMImage>& GetROM() const { return m_rom; }
+
+    // Clone this instance: the child shares the ROM image and starts from the
+    // current machine state. ForkInto reuses the target's components, and
+    // keeps its cartridge when it already runs the same image, so refreshing
+    // a pool of instances doesn't allocate. Host-side settings (render
+    // policy) are not copied.
+    std::unique_ptr<GameBoy> Fork() const;
+    bool ForkInto(GameBoy& child) const;
 
     // System control
     void Reset();
     void RunFrame();
-    void Step();  // Run one instruction
+    void RunCycles(u64 cycles);  // Run at least 'cycles' cycles, event to event
+    void Step();  // Run one CPU block
+
+    // Save states (layout in snapshot.hpp). SaveState reuses the buffer's
+    // storage, so taking a snapshot every frame doesn't allocate. LoadState
+    // only accepts snapshots of the currently loaded ROM.
+    void SaveState(std::vector<u8>& snapshot) const;
+    bool LoadState(const std::vector<u8>& snapshot);
+    bool SaveStateToFile(const std::string& path) const;
+    bool LoadStateFromFile(const std::string& path);
 
-    // Get framebuffer for rendering
+    // Rewind: RunFrame records a snapshot every frame_interval frames into a
+    // history of at most max_bytes (see RewindBuffer). Rewind() restores the
+    // newest recorded point and drops it, so repeated calls walk back in time.
+    void EnableRewind(size_t max_bytes, u32 frame_interval = 1, u32 keyframe_interval = 60);
+    void DisableRewind();
+    bool Rewind();
+    const RewindBuffer* GetRewindBuffer() const { return m_rewind.get(); }
+
+    // Run-ahead: run the real frame, emulate `frames` more frames with the
+    // current input (only the last one drawn), keep that picture and roll
+    // back. What is shown then reflects input up to `frames` frames sooner,
+    // hiding the game's own input lag. Returns the picture as shades (see
+    // GetShadeFramebuffer), valid until the next call; with frames == 0 this
+    // is RunFrame().
+    const u8* RunFrameAhead(u32 frames);
+
+    // Get framebuffer for rendering: 2-bit shades (23KB, what the PPU draws)
+    // or ARGB expanded from them
+    const u8* GetShadeFramebuffer() const { return m_ppu->GetShadeFramebuffer(); }
     const u32* GetFramebuffer() const { return m_ppu->GetFramebuffer(); }
     bool IsFrameReady() const { return m_ppu->IsFrameReady(); }
     void ClearFrameReady() { m_ppu->ClearFrameReady(); }
 
-    // Input (joypad)
-    void SetJoypadState(u8 state) { m_joypad_state = state; }
+    // Skip pixel work for fast-forward and headless runs (see PPU::RenderPolicy)
+    void SetRenderPolicy(PPU::RenderPolicy policy, u32 frame_interval = 1) {
+        m_ppu->SetRenderPolicy(policy, frame_interval);
+    }
+
+    // Draw the next frame whatever the policy (see PPU::DrawNextFrame);
+    // call between frames, before the one that should have pixels
+    void DrawNextFrame() { m_ppu->DrawNextFrame(); }
+
+    // Audio: stream samples into ring at sample_rate Hz (nullptr: no audio,
+    // the APU then skips synthesis entirely)
+    void SetAudioOutput(SampleRing* ring, u32 sample_rate) { m_apu->SetOutput(ring, sample_rate); }
+
+    // Input: bit 0-3 Right, Left, Up, Down; bit 4-7 A, B, Select, Start
+    // (0 = pressed). Pressing a button the game has selected requests the
+    // joypad interrupt.
+    void SetJoypadState(u8 state) { m_joypad->SetState(state); }
 
     // Debug
     bool IsRunning() const { return m_running; }
-    u32 GetCycleCount() const { return m_total_cycles; }
+    u64 GetCycleCount() const { return m_total_cycles; }
+
+    // Hot-path counters gathered since the last ResetPerfStats() (or
+    // construction), speculative run-ahead frames included. Only collected in
+    // DMWSS_PERF_COUNTERS builds; otherwise the result is all zero with
+    // enabled == false.
+    PerfStats GetPerfStats() const;
+    void ResetPerfStats();
+
+    // Event trace: keep the newest `records` interrupts, scheduler events and
+    // code invalidations as binary records (see trace_ring.hpp). Only in
+    // DMWSS_TRACE_RING builds; EnableTrace returns false otherwise.
+    bool EnableTrace(size_t records);
+    void DisableTrace();
+    const TraceRing* GetTraceRing() const { return m_trace.get(); }
 
     // Component access for debugging
     CPU& GetCPU() { return *m_cpu; }
     PPU& GetPPU() { return *m_ppu; }
+    APU& GetAPU() { return *m_apu; }
     Memory& GetMemory() { return *m_memory; }
 
 private:
@@ -47,16 +125,31 @@ private:
     std::unique_ptr<CPU> m_cpu;
     std::unique_ptr<PPU> m_ppu;
     std::unique_ptr<Timer> m_timer;
+    std::unique_ptr<APU> m_apu;
+    std::unique_ptr<DMA> m_dma;
+    std::unique_ptr<Joypad> m_joypad;
 
     // State
     bool m_running;
-    u32 m_total_cycles;
-    u8 m_joypad_state;
-    std::vector<u8> m_rom_data;
+    u64 m_total_cycles;
+    std::shared_ptr<const ROMImage> m_rom;
 
-    // Timing
-    static constexpr u32 CYCLES_PER_FRAME = 70224;  // ~59.73 Hz
+    // Rewind history (null while disabled)
+    std::unique_ptr<RewindBuffer> m_rewind;
+    u32 m_rewind_interval = 1;
+    u32 m_rewind_counter = 0;
+    std::vector<u8> m_rewind_snapshot;
+
+    // Run-ahead rollback point and the picture from the speculative frames
+    std::vector<u8> m_run_ahead_snapshot;
+    std::array<u8, PPU::SCREEN_WIDTH * PPU::SCREEN_HEIGHT> m_run_ahead_shades{};
+
+    // Event trace (null while disabled)
+    std::unique_ptr<TraceRing> m_trace;
 
     // Initialize I/O handlers
     void RegisterIOHandlers();
+
+    // Cartridge identity recorded in snapshots
+    void FillSnapshotHeader(struct SnapshotHeader& header) const;
 };
@@ -0,0 +1,240 @@
+#include "gameboy_batch.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+GameBoyBatch::GameBoyBatch(size_t count, Config config)
+    : m_config(std::move(config)) {
+
+    const u32 downsample = m_config.downsample;
+    const bool valid_downsample = downsample == 1 || downsample == 2 || downsample == 4;
+    if (!valid_downsample || (m_config.observation == Observation::ARGB && downsample != 1)) {
+        spdlog::warn("Unsupported observation downsample factor {}, using 1", downsample);
+        m_config.downsample = 1;
+    }
+    m_observation_width = PPU::SCREEN_WIDTH / m_config.downsample;
+    m_observation_height = PPU::SCREEN_HEIGHT / m_config.downsample;
+
+    const size_t threads = m_config.threads ? m_config.threads
+                                            : std::max(1u, std::thread::hardware_concurrency());
+    m_thread_count = std::min(threads, count);
+
+    m_instances.resize(count);
+    m_workers.reserve(m_thread_count);
+    for (size_t worker = 0; worker < m_thread_count; worker++) {
+        m_workers.emplace_back(&GameBoyBatch::WorkerLoop, this, worker);
+    }
+
+    Dispatch(ConstructTask);
+    spdlog::info("GameBoy batch: {} instances on {} threads", count, m_thread_count);
+}
+
+GameBoyBatch::~GameBoyBatch() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool GameBoyBatch::LoadROM(std::shared_ptr<const ROMImage> rom) {
+    if (!rom) {
+        spdlog::error("Invalid ROM image");
+        return false;
+    }
+
+    m_task_rom = std::move(rom);
+    m_task_failed = false;
+    Dispatch(LoadROMTask);
+    m_task_rom.reset();
+
+    return !m_task_failed;
+}
+
+void GameBoyBatch::Reset() {
+    Dispatch(ResetTask);
+}
+
+void GameBoyBatch::Step(const u8* joypad, u32 frames, u8* observations, u8* memory) {
+    m_task_joypad = joypad;
+    m_task_frames = frames;
+    m_task_observations = observations;
+    m_task_memory = memory;
+    Dispatch(StepTask);
+}
+
+size_t GameBoyBatch::GetObservationSize() const {
+    const size_t pixels = static_cast<size_t>(m_observation_width) * m_observation_height;
+    switch (m_config.observation) {
+        case Observation::NONE:      return 0;
+        case Observation::SHADES:    return pixels;
+        case Observation::GRAYSCALE: return pixels;
+        case Observation::ARGB:      return pixels * sizeof(u32);
+    }
+    return 0;
+}
+
+void GameBoyBatch::WorkerLoop(size_t worker) {
+    const size_t count = m_instances.size();
+    const size_t begin = worker * count / m_thread_count;
+    const size_t end = (worker + 1) * count / m_thread_count;
+
+#if defined(__linux__)
+    if (m_config.pin_threads) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker % cores, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            spdlog::debug("Failed to pin batch worker {} to core {}", worker, worker % cores);
+        }
+    }
+#endif
+
+    u64 generation = 0;
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+            if (m_stop) return;
+            generation = m_generation;
+            task = m_task;
+        }
+
+        task(*this, begin, end);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void GameBoyBatch::Dispatch(Task task) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = task;
+    m_pending = m_thread_count;
+    m_generation++;
+    m_wake.notify_all();
+
+    m_done.wait(lock, [&] { return m_pending == 0; });
+}
+
+void GameBoyBatch::ConstructTask(GameBoyBatch& batch, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        batch.m_instances[i] = std::make_unique<GameBoy>();
+    }
+}
+
+void GameBoyBatch::LoadROMTask(GameBoyBatch& batch, size_t begin, size_t end) {
+    // Only observed frames need pixels: every frame, each step's last one
+    // (drawn through DrawNextFrame), or none without observations
+    const Config& config = batch.m_config;
+    const PPU::RenderPolicy policy = config.observation != Observation::NONE && config.render_every_frame
+        ? PPU::RenderPolicy::FULL : PPU::RenderPolicy::TIMING_ONLY;
+
+    for (size_t i = begin; i < end; i++) {
+        GameBoy& gameboy = *batch.m_instances[i];
+        if (!gameboy.LoadROM(batch.m_task_rom)) {
+            batch.m_task_failed = true;
+        }
+        gameboy.SetRenderPolicy(policy);
+    }
+}
+
+void GameBoyBatch::ResetTask(GameBoyBatch& batch, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        batch.m_instances[i]->Reset();
+    }
+}
+
+void GameBoyBatch::StepTask(GameBoyBatch& batch, size_t begin, size_t end) {
+    const Config& config = batch.m_config;
+    const u32 frames = batch.m_task_frames;
+    const bool observe = config.observation != Observation::NONE;
+
+    // Frames before the last of a step are never observed
+    const bool draw_last_only = observe && !config.render_every_frame;
+
+    const size_t observation_size = batch.GetObservationSize();
+    const size_t memory_size = config.memory_addresses.size();
+
+    for (size_t i = begin; i < end; i++) {
+        GameBoy& gameboy = *batch.m_instances[i];
+        if (batch.m_task_joypad) {
+            gameboy.SetJoypadState(batch.m_task_joypad[i]);
+        }
+
+        for (u32 frame = 0; frame < frames; frame++) {
+            if (draw_last_only && frame + 1 == frames) {
+                gameboy.DrawNextFrame();
+            }
+            gameboy.RunFrame();
+        }
+
+        if (observe && batch.m_task_observations) {
+            batch.WriteObservation(gameboy, batch.m_task_observations + i * observation_size);
+        }
+
+        if (batch.m_task_memory) {
+            u8* out = batch.m_task_memory + i * memory_size;
+            const Memory& memory = gameboy.GetMemory();
+            for (size_t k = 0; k < memory_size; k++) {
+                out[k] = memory.Read(config.memory_addresses[k]);
+            }
+        }
+    }
+}
+
+void GameBoyBatch::WriteObservation(const GameBoy& gameboy, u8* out) const {
+    const u32 factor = m_config.downsample;
+    const u8* shades = gameboy.GetShadeFramebuffer();
+
+    switch (m_config.observation) {
+        case Observation::NONE:
+            return;
+
+        case Observation::ARGB:
+            std::memcpy(out, gameboy.GetFramebuffer(), GetObservationSize());
+            return;
+
+        case Observation::SHADES:
+            if (factor == 1) {
+                std::memcpy(out, shades, GetObservationSize());
+                return;
+            }
+            for (u32 y = 0; y < m_observation_height; y++) {
+                const u8* row = shades + y * factor * PPU::SCREEN_WIDTH;
+                for (u32 x = 0; x < m_observation_width; x++) {
+                    *out++ = row[x * factor];
+                }
+            }
+            return;
+
+        case Observation::GRAYSCALE:
+            // Shade 0..3 -> 255..0, averaged over each factor x factor block
+            for (u32 y = 0; y < m_observation_height; y++) {
+                for (u32 x = 0; x < m_observation_width; x++) {
+                    u32 sum = 0;
+                    for (u32 dy = 0; dy < factor; dy++) {
+                        const u8* row = shades + (y * factor + dy) * PPU::SCREEN_WIDTH + x * factor;
+                        for (u32 dx = 0; dx < factor; dx++) {
+                            sum += row[dx];
+                        }
+                    }
+                    *out++ = static_cast<u8>(255 - sum * 85 / (factor * factor));
+                }
+            }
+            return;
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "gameboy.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// N GameBoys stepped in lockstep, for reinforcement-learning style
+// workloads. Step() hands every instance its joypad state, runs the same
+// number of frames on all of them across a fixed set of worker threads and
+// writes the resulting observations (and selected memory bytes) into
+// caller-provided contiguous buffers, so a step allocates and copies nothing
+// beyond those writes.
+//
+// Each worker owns a contiguous slice of instances for the batch's lifetime,
+// constructs them itself (so their memory comes from the worker's core) and
+// is pinned to a core where the platform allows it.
+class GameBoyBatch {
+public:
+    enum class Observation : u8 {
+        NONE,       // No picture
+        SHADES,     // 1 byte per pixel, 2-bit shade (0 = white .. 3 = black)
+        GRAYSCALE,  // 1 byte per pixel, 255 = white .. 0 = black
+        ARGB        // 4 bytes per pixel, as GameBoy::GetFramebuffer()
+    };
+
+    struct Config {
+        size_t threads = 0;         // 0 = one per hardware thread (never more than instances)
+        bool pin_threads = true;    // Pin worker i to core i (Linux)
+        Observation observation = Observation::SHADES;
+        u32 downsample = 1;         // 1, 2 or 4; SHADES keeps the top-left pixel, GRAYSCALE averages
+        bool render_every_frame = false;  // Otherwise only each step's last frame is drawn
+        std::vector<u16> memory_addresses;  // Bytes read per instance after every step
+    };
+
+    GameBoyBatch(size_t count, Config config);
+    ~GameBoyBatch();
+
+    GameBoyBatch(const GameBoyBatch&) = delete;
+    GameBoyBatch& operator=(const GameBoyBatch&) = delete;
+
+    // Load the same image into every instance (they share it)
+    bool LoadROM(std::shared_ptr<const ROMImage> rom);
+    void Reset();
+
+    // Run `frames` frames on every instance. joypad holds one state per
+    // instance (nullptr: keep the current ones). observations receives
+    // GetObservationSize() bytes per instance and memory GetMemorySize()
+    // bytes per instance, both in instance order; either may be nullptr.
+    void Step(const u8* joypad, u32 frames, u8* observations, u8* memory);
+
+    size_t GetSize() const { return m_instances.size(); }
+    size_t GetThreadCount() const { return m_thread_count; }
+    u32 GetObservationWidth() const { return m_observation_width; }
+    u32 GetObservationHeight() const { return m_observation_height; }
+    size_t GetObservationSize() const;
+    size_t GetMemorySize() const { return m_config.memory_addresses.size(); }
+
+    // Direct access to an instance; only between calls
+    GameBoy& Get(size_t index) { return *m_instances[index]; }
+
+private:
+    // Work for one slice of instances [begin, end)
+    using Task = void (*)(GameBoyBatch& batch, size_t begin, size_t end);
+
+    Config m_config;
+    u32 m_observation_width;
+    u32 m_observation_height;
+    std::vector<std::unique_ptr<GameBoy>> m_instances;
+
+    // Worker pool: every dispatch bumps the generation and waits for all
+    // workers to finish their slice
+    size_t m_thread_count;
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    u64 m_generation = 0;
+    size_t m_pending = 0;
+    bool m_stop = false;
+    Task m_task = nullptr;
+
+    // Arguments of the task being dispatched
+    std::shared_ptr<const ROMImage> m_task_rom;
+    const u8* m_task_joypad = nullptr;
+    u32 m_task_frames = 0;
+    u8* m_task_observations = nullptr;
+    u8* m_task_memory = nullptr;
+    std::atomic<bool> m_task_failed{false};
+
+    void WorkerLoop(size_t worker);
+    void Dispatch(Task task);
+
+    static void ConstructTask(GameBoyBatch& batch, size_t begin, size_t end);
+    static void LoadROMTask(GameBoyBatch& batch, size_t begin, size_t end);
+    static void ResetTask(GameBoyBatch& batch, size_t begin, size_t end);
+    static void StepTask(GameBoyBatch& batch, size_t begin, size_t end);
+
+    void WriteObservation(const GameBoy& gameboy, u8* out) const;
+};
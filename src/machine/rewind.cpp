@@ -0,0 +1,185 @@
+#include "rewind.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t WORD_SIZE = 8;
+
+FORCE_INLINE u64 LoadWord(const u8* data, size_t word) {
+    u64 value;
+    std::memcpy(&value, data + word * WORD_SIZE, WORD_SIZE);
+    return value;
+}
+
+void PutVarint(std::vector<u8>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<u8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<u8>(value));
+}
+
+FORCE_INLINE size_t GetVarint(const u8*& in) {
+    size_t value = 0;
+    for (u32 shift = 0;; shift += 7) {
+        const u8 byte = *in++;
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+// Stream of (unchanged words, changed words, changed bytes...) runs covering
+// the whole words of data, then the trailing bytes verbatim
+void Encode(const u8* data, const u8* reference, size_t size, std::vector<u8>& out) {
+    out.clear();
+    const size_t words = size / WORD_SIZE;
+
+    size_t word = 0;
+    while (word < words) {
+        const size_t same_start = word;
+        while (word < words && LoadWord(data, word) == LoadWord(reference, word)) word++;
+
+        const size_t changed_start = word;
+        while (word < words && LoadWord(data, word) != LoadWord(reference, word)) word++;
+
+        PutVarint(out, changed_start - same_start);
+        PutVarint(out, word - changed_start);
+        out.insert(out.end(), data + changed_start * WORD_SIZE, data + word * WORD_SIZE);
+    }
+
+    out.insert(out.end(), data + words * WORD_SIZE, data + size);
+}
+
+void Decode(const std::vector<u8>& encoded, const u8* reference, size_t size, std::vector<u8>& out) {
+    out.resize(size);
+    std::memcpy(out.data(), reference, size);
+
+    const size_t words = size / WORD_SIZE;
+    const u8* in = encoded.data();
+
+    size_t word = 0;
+    while (word < words) {
+        word += GetVarint(in);
+        const size_t changed = GetVarint(in);
+        std::memcpy(out.data() + word * WORD_SIZE, in, changed * WORD_SIZE);
+        in += changed * WORD_SIZE;
+        word += changed;
+    }
+
+    std::memcpy(out.data() + words * WORD_SIZE, in, size - words * WORD_SIZE);
+}
+
+}  // namespace
+
+RewindBuffer::RewindBuffer(size_t max_bytes, u32 keyframe_interval)
+    : m_max_bytes(max_bytes)
+    , m_keyframe_interval(std::max<u32>(keyframe_interval, 1)) {
+}
+
+void RewindBuffer::Push(const std::vector<u8>& snapshot) {
+    if (snapshot.size() != m_snapshot_size) {
+        Clear();
+        m_snapshot_size = snapshot.size();
+        m_zero.assign(m_snapshot_size, 0);
+    }
+
+    const bool keyframe = m_entries.empty() || m_since_keyframe >= m_keyframe_interval;
+    if (!keyframe && !m_reference_valid && !LoadNewestKeyframe()) {
+        return;
+    }
+
+    Entry entry{AcquireBuffer(), keyframe};
+    Encode(snapshot.data(), keyframe ? m_zero.data() : m_reference.data(), m_snapshot_size, entry.data);
+
+    if (keyframe) {
+        m_reference = snapshot;
+        m_reference_valid = true;
+        m_since_keyframe = 0;
+    }
+    m_since_keyframe++;
+
+    m_used_bytes += entry.data.size();
+    m_entries.push_back(std::move(entry));
+
+    // The newest group always stays, even if it alone is over budget
+    while (m_used_bytes > m_max_bytes && m_since_keyframe < m_entries.size()) {
+        EvictOldestGroup();
+    }
+}
+
+bool RewindBuffer::Pop(std::vector<u8>& snapshot) {
+    if (m_entries.empty()) {
+        return false;
+    }
+
+    Entry& entry = m_entries.back();
+    if (entry.keyframe) {
+        Decode(entry.data, m_zero.data(), m_snapshot_size, snapshot);
+        m_reference_valid = false;
+    } else {
+        if (!m_reference_valid && !LoadNewestKeyframe()) {
+            return false;
+        }
+        Decode(entry.data, m_reference.data(), m_snapshot_size, snapshot);
+    }
+
+    Release(entry);
+    m_entries.pop_back();
+
+    // Entries remaining in the newest group
+    m_since_keyframe = 0;
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        m_since_keyframe++;
+        if (it->keyframe) break;
+    }
+
+    return true;
+}
+
+void RewindBuffer::Clear() {
+    for (Entry& entry : m_entries) {
+        Release(entry);
+    }
+    m_entries.clear();
+    m_used_bytes = 0;
+    m_since_keyframe = 0;
+    m_reference_valid = false;
+}
+
+std::vector<u8> RewindBuffer::AcquireBuffer() {
+    if (m_free_buffers.empty()) {
+        return {};
+    }
+
+    std::vector<u8> buffer = std::move(m_free_buffers.back());
+    m_free_buffers.pop_back();
+    return buffer;
+}
+
+void RewindBuffer::Release(Entry& entry) {
+    m_used_bytes -= entry.data.size();
+
+    // Keep about one group's worth of storage for reuse
+    if (m_free_buffers.size() < m_keyframe_interval) {
+        m_free_buffers.push_back(std::move(entry.data));
+    }
+}
+
+void RewindBuffer::EvictOldestGroup() {
+    do {
+        Release(m_entries.front());
+        m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+}
+
+bool RewindBuffer::LoadNewestKeyframe() {
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        if (it->keyframe) {
+            Decode(it->data, m_zero.data(), m_snapshot_size, m_reference);
+            m_reference_valid = true;
+            return true;
+        }
+    }
+    return false;
+}
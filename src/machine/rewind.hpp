@@ -0,0 +1,54 @@
+#pragma once
+#include "../core/types.hpp"
+#include <deque>
+#include <vector>
+
+// Bounded history of snapshots for rewinding and backtracking.
+//
+// Entries are grouped behind keyframes: every keyframe_interval-th push starts
+// a group and the entries after it store only the 8-byte words that differ
+// from that keyframe, as (unchanged run, changed run) pairs. Restoring any
+// entry is one keyframe decode plus one delta, never a replay chain. When the
+// history exceeds its byte budget the oldest group is dropped whole.
+class RewindBuffer {
+public:
+    RewindBuffer(size_t max_bytes, u32 keyframe_interval);
+
+    // Record a snapshot (all snapshots must be the same size; a different
+    // size, e.g. after loading another ROM, clears the history first)
+    void Push(const std::vector<u8>& snapshot);
+
+    // Decode the newest snapshot into the buffer and drop it
+    bool Pop(std::vector<u8>& snapshot);
+
+    void Clear();
+
+    size_t GetEntryCount() const { return m_entries.size(); }
+    size_t GetMemoryUsage() const { return m_used_bytes; }
+    size_t GetMaxBytes() const { return m_max_bytes; }
+
+private:
+    struct Entry {
+        std::vector<u8> data;  // Encoded words
+        bool keyframe;
+    };
+
+    size_t m_max_bytes;
+    u32 m_keyframe_interval;
+    u32 m_since_keyframe = 0;
+    size_t m_snapshot_size = 0;
+    size_t m_used_bytes = 0;
+
+    std::deque<Entry> m_entries;
+    std::vector<std::vector<u8>> m_free_buffers;  // Recycled entry storage
+
+    // Decoded keyframe of the newest group, the reference for new deltas
+    std::vector<u8> m_reference;
+    bool m_reference_valid = false;
+    std::vector<u8> m_zero;  // Reference for encoding keyframes
+
+    std::vector<u8> AcquireBuffer();
+    void Release(Entry& entry);
+    void EvictOldestGroup();
+    bool LoadNewestKeyframe();
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "../core/types.hpp"
+#include "../core/scheduler/scheduler.hpp"
+#include "../core/memory/memory.hpp"
+#include "../core/cpu/cpu.hpp"
+#include "../core/ppu/ppu.hpp"
+#include "../core/timer/timer.hpp"
+#include "../core/apu/apu.hpp"
+#include "../core/dma/dma.hpp"
+#include <type_traits>
+
+// Save state layout. A snapshot is one flat buffer:
+//
+//   SnapshotHeader | MachineState | cartridge RAM (header.ram_size bytes)
+//
+// Every part is trivially copyable, so saving and restoring are plain copies.
+// Values are in host byte order; a snapshot from a host with the other byte
+// order fails the magic check.
+
+constexpr u32 SNAPSHOT_MAGIC = 0x53534D44;  // "DMSS" in little-endian order
+constexpr u16 SNAPSHOT_VERSION = 6;         // Bump on any layout change
+
+struct SnapshotHeader {
+    u32 magic;
+    u16 version;
+    u16 header_size;    // sizeof(SnapshotHeader)
+    u32 state_size;     // sizeof(MachineState)
+    u32 ram_size;       // Cartridge RAM bytes following the state
+    u32 rom_size;       // The cartridge the snapshot was taken from
+    u16 rom_checksum;   // Global checksum from the cartridge header (0x014E)
+    u8 cartridge_type;
+    u8 reserved;
+};
+
+struct MachineState {
+    Scheduler::State scheduler;
+    CPU::State cpu;
+    Memory::State memory;
+    PPU::State ppu;
+    Timer::State timer;
+    APU::State apu;
+    DMA::State dma;
+    Joypad::State joypad;
+    u64 total_cycles;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+static_assert(std::is_trivially_copyable_v<MachineState>);
+static_assert(sizeof(SnapshotHeader) % alignof(MachineState) == 0,
+              "MachineState must stay aligned after the header");
+
+constexpr size_t SNAPSHOT_STATE_OFFSET = sizeof(SnapshotHeader);
+constexpr size_t SNAPSHOT_RAM_OFFSET = SNAPSHOT_STATE_OFFSET + sizeof(MachineState);
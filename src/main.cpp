@@ -1,15 +1,17 @@
 #include <QApplication>
 #include <QMainWindow>
-#include <QTimer>
 #include <QMenuBar>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QKeyEvent>
 #include <QStatusBar>
+#include <QActionGroup>
 #include <spdlog/spdlog.h>
 #include "core/types.hpp"
 #include "machine/gameboy.hpp"
 #include "ui/gl_widget.hpp"
+#include "ui/audio_output.hpp"
+#include "ui/emulation_thread.hpp"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -19,8 +21,8 @@ public:
         : QMainWindow(parent)
         , m_gameboy(nullptr)
         , m_gl_widget(nullptr)
-        , m_frame_timer(nullptr)
-        , m_joypad_state(0xFF) {
+        , m_joypad_state(0xFF)
+        , m_run_ahead_frames(0) {
 
         setWindowTitle("DMWSS - Game Boy Emulator v0.1.0");
         resize(800, 720);
@@ -33,18 +35,28 @@ public:
         // Create menu bar
         CreateMenus();
 
-        // Create GameBoy instance
+        // Create GameBoy instance and the thread that runs it
         m_gameboy = std::make_unique<GameBoy>();
-
-        // Create frame timer (60 FPS)
-        m_frame_timer = new QTimer(this);
-        connect(m_frame_timer, &QTimer::timeout, this, &MainWindow::OnFrameUpdate);
+        m_emulation = std::make_unique<EmulationThread>(*m_gameboy);
+        m_gl_widget->SetFrameSource(&m_emulation->GetFrames());
+
+        // Audio is optional; without a device the APU skips synthesis and
+        // frames are paced by the clock
+        m_audio = std::make_unique<AudioOutput>();
+        if (m_audio->Start()) {
+            m_emulation->SetAudioOutput(&m_audio->GetRing(), m_audio->GetSampleRate());
+        }
 
         spdlog::info("DMWSS - Game Boy Emulator v0.1.0");
         spdlog::info("Application started successfully");
     }
 
-    ~MainWindow() override = default;
+    ~MainWindow() override {
+        // Stop the producer, then the callback, before the ring goes away
+        m_emulation->Stop();
+        m_audio->Stop();
+        m_emulation->SetAudioOutput(nullptr, 0);
+    }
 
 protected:
     void keyPressEvent(QKeyEvent* event) override {
@@ -68,49 +80,45 @@ private slots:
 
         if (filename.isEmpty()) return;
 
+        // The GameBoy belongs to the emulation thread while it runs
+        const bool was_running = m_emulation->IsRunning();
+        m_emulation->Stop();
+
         if (m_gameboy->LoadROM(filename.toStdString())) {
             spdlog::info("ROM loaded successfully");
-            m_frame_timer->start(16);  // ~60 FPS
+            m_emulation->Start();
             statusBar()->showMessage("ROM loaded: " + filename);
         } else {
+            if (was_running && m_gameboy->IsRunning()) {
+                m_emulation->Start();
+            }
             QMessageBox::critical(this, "Error", "Failed to load ROM");
         }
     }
 
     void OnPause() {
-        if (m_frame_timer->isActive()) {
-            m_frame_timer->stop();
+        if (m_emulation->IsRunning()) {
+            m_emulation->Stop();
             statusBar()->showMessage("Paused");
-        } else {
-            m_frame_timer->start(16);
+        } else if (m_gameboy->IsRunning()) {
+            m_emulation->Start();
             statusBar()->showMessage("Running");
         }
     }
 
     void OnReset() {
         if (m_gameboy->IsRunning()) {
+            const bool was_running = m_emulation->IsRunning();
+            m_emulation->Stop();
             m_gameboy->Reset();
+            if (was_running) {
+                m_emulation->Start();
+            }
             spdlog::info("System reset");
             statusBar()->showMessage("System reset");
         }
     }
 
-    void OnFrameUpdate() {
-        if (!m_gameboy || !m_gameboy->IsRunning()) return;
-
-        // Update joypad state
-        m_gameboy->SetJoypadState(m_joypad_state);
-
-        // Run one frame
-        m_gameboy->RunFrame();
-
-        // Update display if frame is ready
-        if (m_gameboy->IsFrameReady()) {
-            m_gl_widget->UpdateFramebuffer(m_gameboy->GetFramebuffer(), 160, 144);
-            m_gameboy->ClearFrameReady();
-        }
-    }
-
 private:
     void CreateMenus() {
         QMenu* fileMenu = menuBar()->addMenu("&File");
@@ -134,6 +142,30 @@ private:
         QAction* resetAction = emulationMenu->addAction("&Reset");
         resetAction->setShortcut(Qt::Key_R);
         connect(resetAction, &QAction::triggered, this, &MainWindow::OnReset);
+
+        // Fast-forward: unpaced, silent, drawing one frame in four
+        QAction* fastForwardAction = emulationMenu->addAction("&Fast-Forward");
+        fastForwardAction->setShortcut(Qt::Key_F);
+        fastForwardAction->setCheckable(true);
+        connect(fastForwardAction, &QAction::toggled, this, [this](bool enabled) {
+            m_emulation->SetFastForward(enabled);
+            statusBar()->showMessage(enabled ? "Fast-forward on" : "Fast-forward off");
+        });
+
+        // Run-ahead: frames emulated past the real one to cut input lag
+        QMenu* runAheadMenu = emulationMenu->addMenu("Run-&Ahead");
+        QActionGroup* runAheadGroup = new QActionGroup(this);
+        for (u32 frames = 0; frames <= MAX_RUN_AHEAD_FRAMES; frames++) {
+            QAction* action = runAheadMenu->addAction(frames == 0 ? QString("Off") : QString("%1 frame(s)").arg(frames));
+            action->setCheckable(true);
+            action->setChecked(frames == m_run_ahead_frames);
+            runAheadGroup->addAction(action);
+            connect(action, &QAction::triggered, this, [this, frames] {
+                m_run_ahead_frames = frames;
+                m_emulation->SetRunAhead(frames);
+                statusBar()->showMessage(frames ? QString("Run-ahead: %1 frame(s)").arg(frames) : QString("Run-ahead off"));
+            });
+        }
     }
 
     void UpdateJoypad(int key, bool released) {
@@ -163,12 +195,17 @@ private:
         } else {
             m_joypad_state &= ~button_mask;  // Clear bit (pressed)
         }
+        m_emulation->SetJoypadState(m_joypad_state);
     }
 
     std::unique_ptr<GameBoy> m_gameboy;
+    std::unique_ptr<AudioOutput> m_audio;
+    std::unique_ptr<EmulationThread> m_emulation;
     GLWidget* m_gl_widget;
-    QTimer* m_frame_timer;
     u8 m_joypad_state;
+    u32 m_run_ahead_frames;
+
+    static constexpr u32 MAX_RUN_AHEAD_FRAMES = 4;
 };
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,57 @@
+#define MINIAUDIO_IMPLEMENTATION
+#include <miniaudio.h>
+#include "audio_output.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+AudioOutput::AudioOutput()
+    : m_ring(BUFFER_FRAMES)
+    , m_sample_rate(DEFAULT_SAMPLE_RATE) {
+}
+
+AudioOutput::~AudioOutput() {
+    Stop();
+}
+
+bool AudioOutput::Start(u32 sample_rate) {
+    if (m_device) return true;
+
+    ma_device_config config = ma_device_config_init(ma_device_type_playback);
+    config.playback.format = ma_format_s16;
+    config.playback.channels = SampleRing::CHANNELS;
+    config.sampleRate = sample_rate;
+    config.dataCallback = DataCallback;
+    config.pUserData = this;
+
+    auto device = std::make_unique<ma_device>();
+    if (ma_device_init(nullptr, &config, device.get()) != MA_SUCCESS) {
+        spdlog::error("Failed to open audio device");
+        return false;
+    }
+    if (ma_device_start(device.get()) != MA_SUCCESS) {
+        spdlog::error("Failed to start audio device");
+        ma_device_uninit(device.get());
+        return false;
+    }
+
+    m_sample_rate = device->sampleRate;
+    m_device = std::move(device);
+
+    spdlog::info("Audio output: {} Hz", m_sample_rate);
+    return true;
+}
+
+void AudioOutput::Stop() {
+    if (!m_device) return;
+
+    ma_device_uninit(m_device.get());
+    m_device.reset();
+}
+
+void AudioOutput::DataCallback(ma_device* device, void* output, const void*, u32 frame_count) {
+    auto* self = static_cast<AudioOutput*>(device->pUserData);
+    s16* frames = static_cast<s16*>(output);
+
+    const size_t read = self->m_ring.Pop(frames, frame_count);
+    std::fill(frames + read * SampleRing::CHANNELS, frames + frame_count * SampleRing::CHANNELS, s16{0});
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "../core/types.hpp"
+#include "../core/apu/sample_ring.hpp"
+#include <memory>
+
+struct ma_device;
+
+// Audio playback through miniaudio. The emulation side pushes stereo s16
+// frames into GetRing(); the device callback (on miniaudio's thread) pops
+// them and pads any shortfall with silence, so an underrun is a gap rather
+// than a stall.
+class AudioOutput {
+public:
+    static constexpr u32 DEFAULT_SAMPLE_RATE = 48000;
+    static constexpr u32 BUFFER_FRAMES = 4096;  // ~85 ms at 48 kHz
+
+    AudioOutput();
+    ~AudioOutput();
+
+    AudioOutput(const AudioOutput&) = delete;
+    AudioOutput& operator=(const AudioOutput&) = delete;
+
+    // Open the default playback device and start it
+    bool Start(u32 sample_rate = DEFAULT_SAMPLE_RATE);
+    void Stop();
+
+    bool IsStarted() const { return m_device != nullptr; }
+
+    // Rate the device actually runs at (valid after Start)
+    u32 GetSampleRate() const { return m_sample_rate; }
+    SampleRing& GetRing() { return m_ring; }
+
+private:
+    SampleRing m_ring;
+    std::unique_ptr<ma_device> m_device;
+    u32 m_sample_rate;
+
+    static void DataCallback(ma_device* device, void* output, const void* input, u32 frame_count);
+};
@@ -0,0 +1,122 @@
+#include "emulation_thread.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+EmulationThread::EmulationThread(GameBoy& gameboy)
+    : m_gameboy(gameboy) {
+}
+
+EmulationThread::~EmulationThread() {
+    Stop();
+}
+
+void EmulationThread::Start() {
+    if (IsRunning()) return;
+
+    m_stop.store(false, std::memory_order_relaxed);
+    ResetPacing();
+    m_thread = std::thread(&EmulationThread::Run, this);
+}
+
+void EmulationThread::Stop() {
+    if (!IsRunning()) return;
+
+    m_stop.store(true, std::memory_order_relaxed);
+    m_thread.join();
+
+    // Hand the GameBoy back with its normal settings
+    if (m_fast_forwarding) {
+        ApplyFastForward(false);
+    }
+}
+
+void EmulationThread::SetAudioOutput(SampleRing* ring, u32 sample_rate) {
+    m_audio_ring = ring;
+    m_sample_rate = sample_rate;
+    m_gameboy.SetAudioOutput(ring, sample_rate);
+
+    m_audio_target = 0;
+    if (ring) {
+        // Keep about three frames of audio queued; the producer adds one per
+        // frame. A ring too small for that (a very high sample rate) can't
+        // pace emulation, so the clock does instead.
+        const size_t frame_samples = static_cast<size_t>(
+            static_cast<u64>(sample_rate) * GameBoy::CYCLES_PER_FRAME / GameBoy::CLOCK_RATE) + 1;
+        if (ring->GetCapacity() > frame_samples * 2) {
+            m_audio_target = std::min(frame_samples * 3, ring->GetCapacity() - frame_samples * 2);
+        } else {
+            spdlog::warn("Audio buffer too small for {} Hz, pacing on the clock", sample_rate);
+        }
+    }
+}
+
+void EmulationThread::Run() {
+    spdlog::debug("Emulation thread started");
+
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        const bool fast_forward = m_fast_forward.load(std::memory_order_relaxed);
+        if (fast_forward != m_fast_forwarding) {
+            ApplyFastForward(fast_forward);
+        }
+
+        m_gameboy.SetJoypadState(m_joypad_state.load(std::memory_order_relaxed));
+
+        // Run-ahead would only slow fast-forward down
+        const u32 run_ahead = fast_forward ? 0 : m_run_ahead_frames.load(std::memory_order_relaxed);
+        const u8* picture = m_gameboy.RunFrameAhead(run_ahead);
+
+        std::copy_n(picture, m_frames.GetBack().size(), m_frames.GetBack().data());
+        m_frames.Publish();
+
+        // A stopped machine would spin
+        if (!fast_forward || !m_gameboy.IsRunning()) {
+            WaitForNextFrame();
+        }
+    }
+
+    spdlog::debug("Emulation thread stopped");
+}
+
+void EmulationThread::ApplyFastForward(bool enabled) {
+    m_fast_forwarding = enabled;
+
+    // Sped-up audio is useless; the device plays silence meanwhile
+    if (enabled) {
+        m_gameboy.SetAudioOutput(nullptr, 0);
+        m_gameboy.SetRenderPolicy(PPU::RenderPolicy::EVERY_N_FRAMES, FAST_FORWARD_RENDER_INTERVAL);
+    } else {
+        m_gameboy.SetAudioOutput(m_audio_ring, m_sample_rate);
+        m_gameboy.SetRenderPolicy(PPU::RenderPolicy::FULL);
+        ResetPacing();
+    }
+}
+
+void EmulationThread::ResetPacing() {
+    m_pace_start = Clock::now();
+    m_paced_frames = 0;
+}
+
+void EmulationThread::WaitForNextFrame() {
+    if (m_audio_ring && m_audio_target != 0 && !m_fast_forwarding) {
+        // Let the device drain to the target; bounded, so a stalled device
+        // slows emulation down without freezing it
+        const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(FramePeriod(2));
+        while (m_audio_ring->GetAvailable() > m_audio_target && Clock::now() < deadline &&
+               !m_stop.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return;
+    }
+
+    // Deadlines count from the pacing start, so rounding never accumulates
+    m_paced_frames++;
+    const Clock::time_point target = m_pace_start +
+        std::chrono::duration_cast<Clock::duration>(FramePeriod(m_paced_frames));
+
+    if (Clock::now() - target > FramePeriod(MAX_LAG_FRAMES)) {
+        // Too far behind (a stall or a slow host): drop the backlog
+        ResetPacing();
+        return;
+    }
+    std::this_thread::sleep_until(target);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "../core/types.hpp"
+#include "../core/apu/sample_ring.hpp"
+#include "../machine/gameboy.hpp"
+#include "triple_buffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Runs a GameBoy on its own thread so painting and window handling never
+// stall emulation (and the other way round). Finished frames go out as 2-bit
+// shades through a lock-free triple buffer the display picks up at its own
+// rate.
+//
+// Frames are paced by the audio ring when audio is playing (the device
+// clock then drives emulation, so the stream neither underruns nor drifts)
+// and by a steady clock at the Game Boy's 59.73 Hz otherwise. Fast-forward
+// drops pacing and audio and draws one frame in FAST_FORWARD_RENDER_INTERVAL.
+//
+// The GameBoy belongs to the thread while it runs; anything besides the
+// setters below (loading a ROM, reset, save states) needs Stop() first.
+class EmulationThread {
+public:
+    using Frame = std::array<u8, PPU::SCREEN_WIDTH * PPU::SCREEN_HEIGHT>;
+
+    static constexpr u32 FAST_FORWARD_RENDER_INTERVAL = 4;
+
+    explicit EmulationThread(GameBoy& gameboy);
+    ~EmulationThread();
+
+    EmulationThread(const EmulationThread&) = delete;
+    EmulationThread& operator=(const EmulationThread&) = delete;
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // Attach the APU to ring and pace by it (nullptr: clock pacing, no audio).
+    // Only while stopped.
+    void SetAudioOutput(SampleRing* ring, u32 sample_rate);
+
+    // Safe from any thread; applied at the next frame
+    void SetJoypadState(u8 state) { m_joypad_state.store(state, std::memory_order_relaxed); }
+    void SetRunAhead(u32 frames) { m_run_ahead_frames.store(frames, std::memory_order_relaxed); }
+    void SetFastForward(bool enabled) { m_fast_forward.store(enabled, std::memory_order_relaxed); }
+
+    // Consumer side for the display thread
+    TripleBuffer<Frame>& GetFrames() { return m_frames; }
+
+private:
+    // Exact frame period: 70224 cycles at 4194304 Hz
+    using FramePeriod = std::chrono::duration<s64, std::ratio<GameBoy::CYCLES_PER_FRAME, GameBoy::CLOCK_RATE>>;
+    using Clock = std::chrono::steady_clock;
+
+    // Frames the clock may fall behind before it stops trying to catch up
+    static constexpr s64 MAX_LAG_FRAMES = 3;
+
+    GameBoy& m_gameboy;
+    TripleBuffer<Frame> m_frames;
+    std::thread m_thread;
+
+    std::atomic<bool> m_stop{false};
+    std::atomic<u8> m_joypad_state{0xFF};
+    std::atomic<u32> m_run_ahead_frames{0};
+    std::atomic<bool> m_fast_forward{false};
+
+    // Audio pacing
+    SampleRing* m_audio_ring = nullptr;
+    u32 m_sample_rate = 0;
+    size_t m_audio_target = 0;  // Buffered frames to keep the device fed; 0 = clock pacing
+
+    // Emulation thread only
+    bool m_fast_forwarding = false;
+    Clock::time_point m_pace_start;
+    s64 m_paced_frames = 0;
+
+    void Run();
+    void ApplyFastForward(bool enabled);
+    void ResetPacing();
+    void WaitForNextFrame();
+};
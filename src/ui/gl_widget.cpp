@@ -1,20 +1,32 @@
 #include "gl_widget.hpp"
 #include <spdlog/spdlog.h>
 #include <QFile>
+#include <QVector4D>
+#include <cstring>
 
 GLWidget::GLWidget(QWidget* parent)
     : QOpenGLWidget(parent)
     , m_shader_program(nullptr)
     , m_texture(nullptr)
     , m_vbo(QOpenGLBuffer::VertexBuffer)
+    , m_pixel_buffers{QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer), QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer)}
+    , m_pixel_buffer_index(0)
     , m_texture_width(160)
-    , m_texture_height(144) {
+    , m_texture_height(144)
+    , m_frames(nullptr) {
+
+    // Chained repaints follow vsync; the frame source is checked every time
+    connect(this, &QOpenGLWidget::frameSwapped, this, [this] {
+        if (m_frames) update();
+    });
 }
 
 GLWidget::~GLWidget() {
     makeCurrent();
     m_vao.destroy();
     m_vbo.destroy();
+    m_pixel_buffers[0].destroy();
+    m_pixel_buffers[1].destroy();
     delete m_texture;
     delete m_shader_program;
     doneCurrent();
@@ -28,12 +40,13 @@ void GLWidget::initializeGL() {
 
     SetupShaders();
     SetupQuad();
+    SetupPixelBuffers();
 
-    // Create texture
+    // Create texture: one shade per texel, colored in the fragment shader
     m_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
     m_texture->setSize(m_texture_width, m_texture_height);
-    m_texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
-    m_texture->allocateStorage();
+    m_texture->setFormat(QOpenGLTexture::R8_UNorm);
+    m_texture->allocateStorage(QOpenGLTexture::Red, QOpenGLTexture::UInt8);
     m_texture->setMinificationFilter(QOpenGLTexture::Nearest);
     m_texture->setMagnificationFilter(QOpenGLTexture::Nearest);
     m_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
@@ -46,6 +59,11 @@ void GLWidget::paintGL() {
 
     if (!m_shader_program || !m_texture) return;
 
+    // Upload only when the emulator has published something new
+    if (m_frames && m_frames->Acquire()) {
+        UploadFrame(m_frames->GetFront());
+    }
+
     m_shader_program->bind();
     m_texture->bind();
 
@@ -61,30 +79,41 @@ void GLWidget::resizeGL(int w, int h) {
     glViewport(0, 0, w, h);
 }
 
-void GLWidget::UpdateFramebuffer(const u32* data, int width, int height) {
-    if (!m_texture) return;
-
-    if (width != m_texture_width || height != m_texture_height) {
-        m_texture_width = width;
-        m_texture_height = height;
-
-        delete m_texture;
-        m_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
-        m_texture->setSize(m_texture_width, m_texture_height);
-        m_texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
-        m_texture->allocateStorage();
-        m_texture->setMinificationFilter(QOpenGLTexture::Nearest);
-        m_texture->setMagnificationFilter(QOpenGLTexture::Nearest);
-        m_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
-    }
+void GLWidget::SetFrameSource(TripleBuffer<EmulationThread::Frame>* frames) {
+    m_frames = frames;
+    update();
+}
 
-    makeCurrent();
-    m_texture->bind();
-    m_texture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, data);
-    m_texture->release();
-    doneCurrent();
+void GLWidget::UploadFrame(const EmulationThread::Frame& frame) {
+    QOpenGLBuffer& buffer = m_pixel_buffers[m_pixel_buffer_index];
+    m_pixel_buffer_index ^= 1;
+
+    buffer.bind();
+    void* data = buffer.mapRange(0, static_cast<int>(frame.size()),
+                                 QOpenGLBuffer::RangeWrite | QOpenGLBuffer::RangeInvalidateBuffer);
+    if (data) {
+        std::memcpy(data, frame.data(), frame.size());
+        buffer.unmap();
+
+        // Sourced from the bound buffer, so the copy to the texture is queued
+        // instead of blocking here
+        m_texture->bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_texture_width, m_texture_height,
+                        GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        m_texture->release();
+    }
+    buffer.release();
+}
 
-    update();
+void GLWidget::SetupPixelBuffers() {
+    for (QOpenGLBuffer& buffer : m_pixel_buffers) {
+        buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+        buffer.create();
+        buffer.bind();
+        buffer.allocate(m_texture_width * m_texture_height);
+        buffer.release();
+    }
 }
 
 void GLWidget::SetupQuad() {
@@ -157,9 +186,17 @@ void GLWidget::SetupShaders() {
         return;
     }
 
-    // Bind texture uniform
+    // Bind texture uniform and the shade colors
+    QVector4D palette[SHADE_COLORS.size()];
+    for (size_t shade = 0; shade < SHADE_COLORS.size(); shade++) {
+        const u32 color = SHADE_COLORS[shade];
+        palette[shade] = QVector4D(((color >> 16) & 0xFF) / 255.0f, ((color >> 8) & 0xFF) / 255.0f,
+                                   (color & 0xFF) / 255.0f, ((color >> 24) & 0xFF) / 255.0f);
+    }
+
     m_shader_program->bind();
     m_shader_program->setUniformValue("u_screen_texture", 0);
+    m_shader_program->setUniformValueArray("u_palette", palette, static_cast<int>(SHADE_COLORS.size()));
     m_shader_program->release();
 
     spdlog::info("Shaders loaded successfully");
@@ -6,6 +6,7 @@
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLTexture>
 #include "../core/types.hpp"
+#include "emulation_thread.hpp"
 
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core {
     Q_OBJECT
@@ -14,7 +15,12 @@ public:
     explicit GLWidget(QWidget* parent = nullptr);
     ~GLWidget() override;
 
-    void UpdateFramebuffer(const u32* data, int width, int height);
+    // Show frames published by an emulation thread (nullptr: none). While a
+    // source is set the widget repaints on every buffer swap, so new frames
+    // appear at the display's refresh rate without waiting on the emulator.
+    // Frames are uploaded as one byte per pixel and colored by the shader's
+    // palette.
+    void SetFrameSource(TripleBuffer<EmulationThread::Frame>* frames);
 
 protected:
     void initializeGL() override;
@@ -27,9 +33,18 @@ private:
     QOpenGLBuffer m_vbo;
     QOpenGLVertexArrayObject m_vao;
 
+    // Pixel unpack buffers, alternated so filling one never waits on the
+    // texture transfer still reading the other
+    QOpenGLBuffer m_pixel_buffers[2];
+    u32 m_pixel_buffer_index;
+
     int m_texture_width;
     int m_texture_height;
 
+    TripleBuffer<EmulationThread::Frame>* m_frames;
+
     void SetupQuad();
     void SetupShaders();
+    void SetupPixelBuffers();
+    void UploadFrame(const EmulationThread::Frame& frame);
 };
@@ -0,0 +1,48 @@
+#pragma once
+#include "../core/types.hpp"
+#include <array>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer triple buffer. The producer fills
+// GetBack() and publishes it; the consumer picks up the newest published slot
+// with Acquire() and reads GetFront(). Neither side ever waits for the other:
+// a producer that outruns the consumer overwrites the unread frame, and a
+// consumer that outruns the producer keeps showing the last one.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer
+    T& GetBack() { return m_slots[m_back]; }
+
+    void Publish() {
+        const u8 previous = m_middle.exchange(static_cast<u8>(m_back | FRESH), std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Consumer: returns whether a new frame replaced the front one
+    bool Acquire() {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+        const u8 previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& GetFront() const { return m_slots[m_front]; }
+
+private:
+    static constexpr u8 INDEX_MASK = 0x03;
+    static constexpr u8 FRESH = 0x04;   // Middle slot holds an unread frame
+
+    std::array<T, 3> m_slots{};
+
+    // Each slot index is owned by exactly one of back, middle and front
+    u8 m_back = 0;
+    alignas(64) std::atomic<u8> m_middle{1};
+    alignas(64) u8 m_front = 2;
+};